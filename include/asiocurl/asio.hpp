@@ -13,6 +13,9 @@
 #ifndef BOOST_ASIO_HAS_STD_CHRONO
 #define BOOST_ASIO_HAS_STD_CHRONO
 #endif
+//	Some versions of boost/asio/awaitable.hpp use std::exchange
+//	without including this header
+#include <utility>
 #include <boost/asio.hpp>
 //	I don't know why this is necessary
 #include <boost/asio/steady_timer.hpp>
@@ -0,0 +1,242 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "asio.hpp"
+#include "error.hpp"
+#include "io_service.hpp"
+#include <curl/curl.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	Performs a transfer through an \ref io_service and exposes
+	 *	its response body as an ASIO AsyncReadStream.
+	 *
+	 *	Data is copied directly from libcurl into the buffers
+	 *	supplied to \ref async_read_some.  While no read is
+	 *	outstanding the transfer is paused (by returning
+	 *	CURL_WRITEFUNC_PAUSE from the write callback) so that at
+	 *	most one chunk of the response body is held in memory and
+	 *	the sender is slowed by TCP flow control rather than the
+	 *	response being buffered.
+	 *
+	 *	Once the entire body has been read reads fail with
+	 *	asio::error::eof if the transfer succeeded or with an
+	 *	error_code describing why it failed otherwise.
+	 */
+	class body_stream {
+
+
+		public:
+
+
+			/**
+			 *	The type of the executor on which completion handlers
+			 *	are invoked by default.
+			 */
+			using executor_type=asio::io_service::executor_type;
+
+
+		private:
+
+
+			class operation {
+
+
+				public:
+
+
+					virtual ~operation () noexcept;
+
+
+					//	Must not invoke the completion handler inline:
+					//	This is called from within libcurl callbacks
+					virtual void complete (error_code, std::size_t) = 0;
+
+
+			};
+
+
+			template <typename Handler>
+			class read_operation;
+
+
+			using operation_ptr=std::unique_ptr<operation>;
+
+
+			//	Shared with the completion handler of the transfer so
+			//	that it survives until libcurl is done with it
+			class state {
+
+
+				public:
+
+
+					std::mutex m;
+					io_service & curl;
+					CURL * easy;
+					asio::mutable_buffer target;
+					operation_ptr op;
+					//	The part of the last chunk delivered by libcurl
+					//	which did not fit in the reader's buffer
+					std::vector<char> leftover;
+					std::size_t offset;
+					bool paused;
+					bool done;
+					error_code result;
+
+
+					state (io_service &, CURL *);
+
+
+					static std::size_t write (char *, std::size_t, std::size_t, void *) noexcept;
+
+
+					void finish (error_code, const CURLMsg &) noexcept;
+					void read (asio::mutable_buffer, operation_ptr);
+
+
+			};
+
+
+			std::shared_ptr<state> state_;
+
+
+		public:
+
+
+			body_stream () = delete;
+			body_stream (const body_stream &) = delete;
+			body_stream (body_stream &&) = delete;
+			body_stream & operator = (const body_stream &) = delete;
+			body_stream & operator = (body_stream &&) = delete;
+
+
+			/**
+			 *	Sets CURLOPT_WRITEFUNCTION and CURLOPT_WRITEDATA on an
+			 *	easy handle and adds it to an io_service.
+			 *
+			 *	All requirements and guarantees of \ref io_service::add
+			 *	apply.
+			 *
+			 *	\param [in] curl
+			 *		The io_service which shall perform the transfer.
+			 *	\param [in] easy
+			 *		The easy handle which represents the transfer.
+			 */
+			body_stream (io_service & curl, CURL * easy);
+
+
+			/**
+			 *	If the transfer has not completed it is removed from
+			 *	the io_service.  An outstanding read completes with
+			 *	asio::error::operation_aborted.
+			 */
+			~body_stream () noexcept;
+
+
+			/**
+			 *	Retrieves the executor associated with the io_service
+			 *	which performs the transfer.
+			 *
+			 *	\return
+			 *		An executor.
+			 */
+			executor_type get_executor () noexcept;
+
+
+			/**
+			 *	Reads some of the response body.
+			 *
+			 *	Only the first non-empty buffer in \em buffers is
+			 *	filled.  At most one read may be outstanding at a time.
+			 *	The completion handler is never invoked from within this
+			 *	function.
+			 *
+			 *	\param [in] buffers
+			 *		The buffers into which to read.  The memory they
+			 *		refer to must remain valid until the completion
+			 *		handler is invoked.
+			 *	\param [in] token
+			 *		An ASIO completion token for the signature
+			 *		void (error_code, std::size_t).
+			 *
+			 *	\return
+			 *		Whatever \em token dictates.
+			 */
+			template <typename MutableBufferSequence, typename CompletionToken>
+			auto async_read_some (const MutableBufferSequence & buffers, CompletionToken && token);
+
+
+	};
+
+
+	template <typename Handler>
+	class body_stream::read_operation : public operation {
+
+
+		private:
+
+
+			using executor_type=asio::associated_executor_t<Handler,asio::io_service::executor_type>;
+
+
+			Handler h_;
+			asio::executor_work_guard<executor_type> work_;
+
+
+		public:
+
+
+			read_operation (Handler h, asio::io_service & ios)
+				:	h_(std::move(h)),
+					work_(asio::get_associated_executor(h_,ios.get_executor()))
+			{	}
+
+
+			virtual void complete (error_code ec, std::size_t n) override {
+
+				auto executor=work_.get_executor();
+				work_.reset();
+				asio::post(executor,[h=std::move(h_),ec,n] () mutable {	h(ec,n);	});
+
+			}
+
+
+	};
+
+
+	template <typename MutableBufferSequence, typename CompletionToken>
+	auto body_stream::async_read_some (const MutableBufferSequence & buffers, CompletionToken && token) {
+
+		return asio::async_initiate<CompletionToken,void (error_code, std::size_t)>([this] (auto handler, const MutableBufferSequence & buffers) {
+
+			asio::mutable_buffer target;
+			for (auto begin=asio::buffer_sequence_begin(buffers),end=asio::buffer_sequence_end(buffers);begin!=end;++begin) {
+
+				target=asio::mutable_buffer(*begin);
+				if (target.size()!=0) break;
+
+			}
+
+			operation_ptr op(new read_operation<decltype(handler)>(std::move(handler),state_->curl.get_io_service()));
+			state_->read(target,std::move(op));
+
+		},token,buffers);
+
+	}
+
+
+}
@@ -0,0 +1,214 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "easy.hpp"
+#include "optional.hpp"
+#include <curl/curl.h>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	Recycles curl easy handles so that each request need not
+	 *	create and configure one, and so that the state which
+	 *	curl_easy_reset keeps in an easy handle (such as cookies)
+	 *	survives from one request to the next.
+	 *
+	 *	Connections and the DNS cache are not among that state for
+	 *	easy handles driven by an \ref io_service: While an easy
+	 *	handle is in a curl multi handle libcurl keeps those in the
+	 *	multi handle, so they are reused whether or not the easy
+	 *	handle is pooled.
+	 *
+	 *	Handles are obtained by calling \ref acquire and are returned
+	 *	to the pool when the lifetime of the returned \ref handle
+	 *	object ends.  All member functions are thread safe.
+	 */
+	class easy_pool {
+
+
+		public:
+
+
+			/**
+			 *	The type of a function which prepares an easy handle
+			 *	before it is handed out.
+			 */
+			using initializer_type=std::function<void (easy &)>;
+
+
+			/**
+			 *	Represents exclusive use of an easy handle owned by an
+			 *	\ref easy_pool.
+			 *
+			 *	When the lifetime of this object ends the easy handle is
+			 *	returned to the pool.  At that point the easy handle must
+			 *	not be in use (for example it must not be managed by an
+			 *	\ref io_service) or the behaviour is undefined.
+			 */
+			class handle {
+
+
+				friend class easy_pool;
+
+
+				private:
+
+
+					easy_pool * pool_;
+					easy easy_;
+
+
+					handle (easy_pool &, easy) noexcept;
+
+
+					void destroy () noexcept;
+
+
+				public:
+
+
+					handle () = delete;
+					handle (const handle &) = delete;
+					handle & operator = (const handle &) = delete;
+
+
+					handle (handle &&) noexcept;
+					handle & operator = (handle &&) noexcept;
+
+
+					/**
+					 *	Returns the easy handle to the pool.
+					 */
+					~handle () noexcept;
+
+
+					/**
+					 *	Retrieves the leased easy object.
+					 *
+					 *	\return
+					 *		A reference to an easy object.
+					 */
+					easy & get () noexcept;
+
+
+					/**
+					 *	Retrieves the leased curl easy handle, allowing
+					 *	this object to be used as a drop-in replacement
+					 *	for a raw curl easy handle.
+					 *
+					 *	\return
+					 *		A curl easy handle.
+					 */
+					operator easy::native_handle_type () const noexcept;
+
+
+			};
+
+
+		private:
+
+
+			mutable std::mutex m_;
+			std::vector<easy> idle_;
+			std::size_t max_idle_;
+			optional<easy> prototype_;
+			//	libcurl forbids using an easy handle from several
+			//	threads at once, duplicating included
+			std::mutex prototype_m_;
+			initializer_type init_;
+
+
+			easy create ();
+			void release (easy) noexcept;
+
+
+		public:
+
+
+			easy_pool () = delete;
+			easy_pool (const easy_pool &) = delete;
+			easy_pool (easy_pool &&) = delete;
+			easy_pool & operator = (const easy_pool &) = delete;
+			easy_pool & operator = (easy_pool &&) = delete;
+
+
+			/**
+			 *	Creates an easy_pool which hands out freshly-created
+			 *	easy handles.
+			 *
+			 *	\param [in] max_idle
+			 *		The maximum number of easy handles which the pool
+			 *		retains while they are not in use, handles returned
+			 *		while this many are idle are cleaned up.
+			 *	\param [in] init
+			 *		A function which is invoked on each easy handle when
+			 *		it is created and each time it is reset, if any.
+			 */
+			explicit easy_pool (std::size_t max_idle, initializer_type init=initializer_type{});
+			/**
+			 *	Creates an easy_pool which creates easy handles by
+			 *	duplicating a prototype.
+			 *
+			 *	Since curl_easy_reset restores all options to their
+			 *	defaults options which are required on every easy handle
+			 *	handed out should be set by \em init rather than on the
+			 *	prototype, the prototype is intended to carry state which
+			 *	curl_easy_duphandle copies but which is expensive to
+			 *	establish.
+			 *
+			 *	\param [in] prototype
+			 *		The easy handle to duplicate.  Its lifetime need not
+			 *		persist.
+			 *	\param [in] max_idle
+			 *		See above.
+			 *	\param [in] init
+			 *		See above.
+			 */
+			easy_pool (const easy & prototype, std::size_t max_idle, initializer_type init=initializer_type{});
+
+
+			/**
+			 *	Cleans up all idle easy handles.
+			 *
+			 *	All \ref handle objects obtained from this pool must
+			 *	have been destroyed or the behaviour is undefined.
+			 */
+			~easy_pool () noexcept;
+
+
+			/**
+			 *	Obtains an easy handle, reusing an idle easy handle if
+			 *	one is available.
+			 *
+			 *	\return
+			 *		An object which returns the easy handle to this pool
+			 *		when its lifetime ends.
+			 */
+			handle acquire ();
+
+
+			/**
+			 *	Determines the number of idle easy handles.
+			 *
+			 *	\return
+			 *		The number of easy handles which have been returned
+			 *		to the pool and which have not yet been reused.
+			 */
+			std::size_t idle () const noexcept;
+
+
+	};
+
+
+}
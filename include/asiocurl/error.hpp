@@ -0,0 +1,75 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "configure.hpp"
+#include <curl/curl.h>
+
+
+#ifdef ASIOCURL_USE_BOOST_ASIO
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#else
+#include <system_error>
+#endif
+
+
+namespace asiocurl {
+
+
+	#ifdef ASIOCURL_USE_BOOST_ASIO
+	using boost::system::error_category;
+	using boost::system::error_code;
+	using boost::system::system_error;
+	#else
+	using std::error_category;
+	using std::error_code;
+	using std::system_error;
+	#endif
+
+
+	/**
+	 *	Retrieves the error category which represents CURLcode
+	 *	values.
+	 *
+	 *	\return
+	 *		A reference to an error category.
+	 */
+	const error_category & easy_category () noexcept;
+	/**
+	 *	Retrieves the error category which represents CURLMcode
+	 *	values.
+	 *
+	 *	\return
+	 *		A reference to an error category.
+	 */
+	const error_category & multi_category () noexcept;
+
+
+	/**
+	 *	Creates an error_code which represents a certain CURLcode.
+	 *
+	 *	\param [in] code
+	 *		The CURLcode.
+	 *
+	 *	\return
+	 *		An error_code whose category is \ref easy_category.
+	 */
+	error_code make_error_code (CURLcode code) noexcept;
+	/**
+	 *	Creates an error_code which represents a certain CURLMcode.
+	 *
+	 *	\param [in] code
+	 *		The CURLMcode.
+	 *
+	 *	\return
+	 *		An error_code whose category is \ref multi_category.
+	 */
+	error_code make_error_code (CURLMcode code) noexcept;
+
+
+}
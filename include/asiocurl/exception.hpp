@@ -142,4 +142,48 @@ namespace asiocurl {
 	};
 
 
+	/**
+	 *	Represents an exception caused by the libcurl share
+	 *	interface.  Specifically an exception of this type
+	 *	wraps a CURLSHcode.
+	 */
+	class share_error : public error {
+
+
+		private:
+
+
+			CURLSHcode code_;
+
+
+		public:
+
+
+			share_error () = delete;
+
+
+			/**
+			 *	Creates a share_error which represents a certain
+			 *	CURLSHcode value.
+			 *
+			 *	\param [in] code
+			 *		The CURLSHcode value which the created object
+			 *		shall represent.
+			 */
+			explicit share_error (CURLSHcode code);
+
+
+			/**
+			 *	Retrieves the CURLSHcode which this object
+			 *	represents.
+			 *
+			 *	\return
+			 *		A CURLSHcode.
+			 */
+			CURLSHcode code () const noexcept;
+
+
+	};
+
+
 }
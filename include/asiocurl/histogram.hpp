@@ -0,0 +1,199 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	A histogram of durations with a bounded relative error in
+	 *	the manner of an HDR histogram.
+	 *
+	 *	Durations are recorded with microsecond resolution.  Those
+	 *	shorter than 16 microseconds are recorded exactly, longer
+	 *	durations fall into one of 16 equally sized buckets for each
+	 *	power of two and are therefore reported with a relative error
+	 *	of at most 6.25%.  Durations of 2<sup>40</sup> microseconds
+	 *	(about 12.7 days) or longer are recorded as though they were
+	 *	that long.
+	 */
+	class histogram {
+
+
+		public:
+
+
+			/**
+			 *	The number of buckets.
+			 */
+			static constexpr std::size_t buckets=592;
+
+
+			/**
+			 *	Determines the bucket into which a duration falls.
+			 *
+			 *	\param [in] us
+			 *		The duration in microseconds.
+			 *
+			 *	\return
+			 *		The index of the bucket.
+			 */
+			static std::size_t bucket (std::uint64_t us) noexcept;
+			/**
+			 *	Determines the greatest duration which falls into a
+			 *	certain bucket.
+			 *
+			 *	\param [in] i
+			 *		The index of the bucket.
+			 *
+			 *	\return
+			 *		The duration in microseconds.
+			 */
+			static std::uint64_t upper_bound (std::size_t i) noexcept;
+
+
+		private:
+
+
+			std::array<std::uint64_t,buckets> counts_;
+			std::uint64_t count_;
+			std::uint64_t max_;
+
+
+			friend class atomic_histogram;
+
+
+		public:
+
+
+			/**
+			 *	Creates an empty histogram.
+			 */
+			histogram () noexcept;
+
+
+			/**
+			 *	Records a duration.
+			 *
+			 *	\param [in] d
+			 *		The duration.  Negative durations are recorded
+			 *		as zero.
+			 */
+			void record (std::chrono::microseconds d) noexcept;
+			/**
+			 *	Adds all durations recorded by another histogram
+			 *	to this histogram.
+			 *
+			 *	\param [in] other
+			 *		The other histogram.
+			 *
+			 *	\return
+			 *		A reference to this object.
+			 */
+			histogram & merge (const histogram & other) noexcept;
+
+
+			/**
+			 *	The number of durations recorded.
+			 */
+			std::uint64_t count () const noexcept;
+			/**
+			 *	The number of durations recorded in a certain bucket.
+			 *
+			 *	\param [in] i
+			 *		The index of the bucket.
+			 *
+			 *	\return
+			 *		The number of durations.
+			 */
+			std::uint64_t count (std::size_t i) const noexcept;
+			/**
+			 *	The longest duration recorded, or zero if no durations
+			 *	have been recorded.
+			 */
+			std::chrono::microseconds max () const noexcept;
+			/**
+			 *	Determines the duration which a certain proportion of
+			 *	recorded durations do not exceed.
+			 *
+			 *	\param [in] p
+			 *		The proportion, for example 0.99 for the 99th
+			 *		percentile.
+			 *
+			 *	\return
+			 *		The duration, or zero if no durations have been
+			 *		recorded.
+			 */
+			std::chrono::microseconds percentile (double p) const noexcept;
+
+
+	};
+
+
+	/**
+	 *	A histogram which one thread records into while any
+	 *	number of other threads concurrently take snapshots thereof.
+	 *
+	 *	Recording consists of relaxed loads and stores and therefore
+	 *	does not contend with snapshots.  Concurrent calls to
+	 *	\ref record must be serialized by the caller.
+	 */
+	class atomic_histogram {
+
+
+		private:
+
+
+			std::array<std::atomic<std::uint64_t>,histogram::buckets> counts_;
+			std::atomic<std::uint64_t> max_;
+
+
+		public:
+
+
+			atomic_histogram (const atomic_histogram &) = delete;
+			atomic_histogram (atomic_histogram &&) = delete;
+			atomic_histogram & operator = (const atomic_histogram &) = delete;
+			atomic_histogram & operator = (atomic_histogram &&) = delete;
+
+
+			/**
+			 *	Creates an empty atomic_histogram.
+			 */
+			atomic_histogram () noexcept;
+
+
+			/**
+			 *	Records a duration.
+			 *
+			 *	\param [in] d
+			 *		The duration.
+			 */
+			void record (std::chrono::microseconds d) noexcept;
+			/**
+			 *	Obtains a copy of the durations recorded so far.
+			 *
+			 *	Durations recorded while the snapshot is being taken
+			 *	may or may not be included.
+			 *
+			 *	\return
+			 *		A histogram.
+			 */
+			histogram snapshot () const noexcept;
+
+
+	};
+
+
+}
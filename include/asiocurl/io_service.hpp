@@ -7,20 +7,55 @@
 
 
 #include "asio.hpp"
+#include "error.hpp"
 #include "future.hpp"
+#include "histogram.hpp"
+#include "metrics.hpp"
+#include "oneshot.hpp"
+#include "optional.hpp"
+#include "slab_pool.hpp"
+#include "transfer_stats.hpp"
 #include <curl/curl.h>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+/**
+ *	Defined if the compiler supports C++20 coroutines, in which
+ *	case \ref asiocurl::io_service::perform is available.
+ */
+#define ASIOCURL_HAS_COROUTINES
+#endif
 
 
 namespace asiocurl {
 
 
+	class share;
+
+
 	/**
 	 *	Services curl easy handles using ASIO.
+	 *
+	 *	libcurl may ask that descriptors it did not open through
+	 *	CURLOPT_OPENSOCKETFUNCTION (for example the socketpair by
+	 *	which its threaded resolver signals) be waited upon, these
+	 *	are waited upon through a duplicate.  On Windows only
+	 *	sockets may be duplicated and waited upon, a transfer for
+	 *	which libcurl asks that any other descriptor be waited upon
+	 *	fails.
 	 */
 	class io_service {
 
@@ -34,9 +69,220 @@ namespace asiocurl {
 			using native_handle_type=CURLM *;
 
 
+			/**
+			 *	Determines how an io_service serializes access to
+			 *	its curl multi handle.
+			 */
+			enum class serialization {
+
+				/**
+				 *	Every completion handler and every call to
+				 *	\ref add and \ref remove acquires a mutex.
+				 *
+				 *	When several threads run the associated
+				 *	asio::io_service they block on this mutex while
+				 *	another thread is servicing the io_service.
+				 */
+				mutex,
+				/**
+				 *	All completion handlers run on an asio::io_service::strand
+				 *	and calls to \ref add and \ref remove from outside that
+				 *	strand are posted thereto rather than being performed
+				 *	immediately.
+				 *
+				 *	When several threads run the associated asio::io_service
+				 *	the strand queues work for this io_service rather than
+				 *	blocking those threads, leaving them free to run other
+				 *	handlers.
+				 */
+				strand
+
+			};
+
+
+			/**
+			 *	The priority class of a transfer.
+			 *
+			 *	When the number of transfers in flight is limited (see
+			 *	\ref options::max_in_flight) transfers which cannot begin
+			 *	immediately wait in a queue for their class.  When a
+			 *	transfer finishes the oldest waiting transfer of the
+			 *	highest class with any waiting transfers begins.  Lower
+			 *	classes therefore wait for as long as higher classes keep
+			 *	the io_service saturated.
+			 */
+			enum class priority {
+
+				high,
+				normal,
+				low
+
+			};
+
+
+			/**
+			 *	Connection limits, HTTP/2 multiplexing behaviour, and
+			 *	admission control applied to the curl multi handle.
+			 *
+			 *	Members which are disengaged leave the corresponding
+			 *	libcurl setting as it is.
+			 */
+			class options {
+
+
+				public:
+
+
+					/**
+					 *	Whether transfers to the same host may share a
+					 *	single HTTP/2 connection (CURLMOPT_PIPELINING).
+					 */
+					optional<bool> multiplex;
+					/**
+					 *	The maximum number of connections to any one host
+					 *	(CURLMOPT_MAX_HOST_CONNECTIONS).  Transfers beyond
+					 *	this limit wait for a connection rather than failing.
+					 */
+					optional<long> max_host_connections;
+					/**
+					 *	The maximum number of connections to all hosts
+					 *	(CURLMOPT_MAX_TOTAL_CONNECTIONS).  Transfers beyond
+					 *	this limit wait for a connection rather than failing.
+					 */
+					optional<long> max_total_connections;
+					/**
+					 *	The maximum number of idle connections retained
+					 *	for reuse (CURLMOPT_MAXCONNECTS).
+					 */
+					optional<long> max_connects;
+					/**
+					 *	The maximum number of concurrent streams on each
+					 *	HTTP/2 connection (CURLMOPT_MAX_CONCURRENT_STREAMS).
+					 *	Requires libcurl 7.67.0 or later.
+					 */
+					optional<long> max_concurrent_streams;
+					/**
+					 *	The maximum number of transfers which are added to
+					 *	the curl multi handle at once, zero for no limit
+					 *	(the default).  Transfers beyond this limit wait
+					 *	in a queue (see \ref priority) rather than
+					 *	contending for connections and file descriptors.
+					 */
+					optional<std::size_t> max_in_flight;
+					/**
+					 *	Whether the \ref transfer_stats of each completed
+					 *	transfer are recorded in the latency histograms and
+					 *	byte counters reported by \ref metrics.  Defaults to
+					 *	\em false, in which case only the remaining counters
+					 *	and gauges are maintained.
+					 */
+					optional<bool> instrument;
+					/**
+					 *	Whether sockets which become ready during the same
+					 *	pass of the reactor are serviced together.  Rather
+					 *	than each being serviced as soon as it is ready they
+					 *	are gathered and then serviced back to back under a
+					 *	single acquisition of this io_service's lock, after
+					 *	which completed transfers are reaped once.  This
+					 *	reduces the cost of each event when many sockets
+					 *	become ready at once at the price of a posted
+					 *	handler per pass.  Defaults to \em false.
+					 *
+					 *	A pass is only gathered in its entirety when a
+					 *	single thread runs the asio::io_service.  When
+					 *	several threads run it the posted handler may run
+					 *	before the handlers of some of the sockets which
+					 *	became ready during the same pass, which are then
+					 *	serviced in a later batch, so batches are smaller
+					 *	but events are never lost or delayed beyond the
+					 *	next posted handler.
+					 */
+					optional<bool> batch_events;
+
+
+			};
+
+
 		private:
 
 
+			class handler_memory {
+
+
+				private:
+
+
+					class block {
+
+
+						public:
+
+
+							alignas(std::max_align_t) unsigned char storage [256];
+							std::atomic<bool> in_use;
+
+
+					};
+
+
+					block blocks_ [2];
+
+
+				public:
+
+
+					handler_memory (const handler_memory &) = delete;
+					handler_memory (handler_memory &&) = delete;
+					handler_memory & operator = (const handler_memory &) = delete;
+					handler_memory & operator = (handler_memory &&) = delete;
+
+
+					handler_memory () noexcept;
+
+
+					void * allocate (std::size_t);
+					void deallocate (void *) noexcept;
+
+
+			};
+
+
+			template <typename T>
+			class handler_allocator;
+
+
+			template <typename Handler>
+			class allocating_handler;
+
+
+			//	Handlers for asynchronous operations refer to the state
+			//	they act upon through a slot, when that state ceases to
+			//	exist the generation of its slot is incremented, allowing
+			//	handlers to detect that they are stale without requiring
+			//	that they share ownership of anything
+			class slot {
+
+
+				public:
+
+
+					std::size_t generation;
+					handler_memory memory;
+					slot * next;
+
+
+					slot (const slot &) = delete;
+					slot (slot &&) = delete;
+					slot & operator = (const slot &) = delete;
+					slot & operator = (slot &&) = delete;
+
+
+					slot () noexcept;
+
+
+			};
+
+
 			class control {
 
 
@@ -45,30 +291,162 @@ namespace asiocurl {
 
 					using mutex_type=std::recursive_mutex;
 					mutable mutex_type m_;
-					bool stop_;
+					std::deque<slot> slots_;
+					slot * free_;
 
 
 				public:
 
 
+					control * next;
+
+
 					control (const control &) = delete;
 					control (control &&) = delete;
 					control & operator = (const control &) = delete;
 					control & operator = (control &&) = delete;
 
 
-					control ();
+					control () noexcept;
 
 
 					using guard_type=std::unique_lock<mutex_type>;
 					guard_type lock () const noexcept;
+					slot & acquire ();
+					void release (slot &) noexcept;
+
+
+			};
+
+
+			//	Owns the control objects for all io_service objects
+			//	associated with a certain asio::io_service, since
+			//	it is destroyed only after all pending handlers have
+			//	been destroyed those handlers may safely refer to
+			//	control objects (and the slots and memory they own)
+			//	even after the io_service which used them is gone
+			class registry;
+
+
+			class control_deleter {
+
+
+				public:
+
+
+					registry * r;
+
+
+					void operator () (control *) const noexcept;
+
+
+			};
+
+
+			class slot_deleter {
+
+
+				public:
+
+
+					control * c;
+
+
+					void operator () (slot *) const noexcept;
+
+
+			};
+
+
+			using control_ptr=std::unique_ptr<control,control_deleter>;
+			using slot_ptr=std::unique_ptr<slot,slot_deleter>;
+
+
+			class slot_ref {
+
+
+				private:
+
+
+					control * c_;
+					slot * s_;
+					std::size_t generation_;
+
+
+				public:
+
+
+					slot_ref (control &, slot &) noexcept;
+
+
+					control::guard_type lock () const noexcept;
+					explicit operator bool () const noexcept;
+
+
+			};
+
+
+			//	A type erased, move only callable with the signature
+			//	void (error_code, const CURLMsg &) which may be
+			//	invoked at most once and which stores small callables
+			//	without allocating
+			class completion {
+
+
+				private:
+
+
+					using storage_type=std::aligned_storage<128,alignof(std::max_align_t)>::type;
+
+
+					template <typename F>
+					static constexpr bool is_inline () noexcept {
+
+						return (sizeof(F)<=sizeof(storage_type)) && std::is_nothrow_move_constructible<F>::value;
+
+					}
+
+
+					template <typename F, bool=is_inline<F>()>
+					class model;
+
+
+					storage_type storage_;
+					void (*invoke_) (completion &, error_code, const CURLMsg &);
+					void (*relocate_) (completion &, completion &) noexcept;
+					void (*destroy_) (completion &) noexcept;
+
+
+				public:
+
+
+					completion (const completion &) = delete;
+					completion & operator = (const completion &) = delete;
+
+
+					completion () noexcept;
+					completion (completion &&) noexcept;
+					completion & operator = (completion &&) noexcept;
+					~completion () noexcept;
+
+
+					template <typename F>
+					explicit completion (F f);
+
+
 					explicit operator bool () const noexcept;
-					void stop () noexcept;
+					void operator () (error_code, const CURLMsg &);
 
 
 			};
 
 
+			template <typename Handler>
+			class token_completion;
+			template <typename Handler>
+			class stats_completion;
+
+
 			class easy_state {
 
 
@@ -76,8 +454,22 @@ namespace asiocurl {
 
 
 					CURL * easy;
-					std::exception_ptr ex;
-					asiocurl::promise<CURLMsg> promise;
+					char * priv;
+					//	Whether CURLOPT_SHARE was set and must therefore
+					//	be cleared
+					bool shared;
+					//	The first error encountered while performing the
+					//	transfer (if any), reported in place of the result
+					error_code ec;
+					completion handler;
+					//	Whether the transfer is waiting for admission
+					//	rather than being in the curl multi handle
+					bool queued;
+					priority level;
+					//	Whether the transfer is about to be aborted
+					//	because of an error which affected all the
+					//	transfers in flight
+					bool failed;
 
 
 					easy_state () = delete;
@@ -90,8 +482,52 @@ namespace asiocurl {
 					explicit easy_state (CURL *);
 
 
-					void set_exception () noexcept;
-					void set_exception (std::exception_ptr) noexcept;
+					void fail (error_code) noexcept;
+					void restore () noexcept;
+
+
+			};
+
+
+			//	Only ever written while the lock is held, but may be
+			//	read at any time
+			class recorder {
+
+
+				public:
+
+
+					std::atomic<std::uint64_t> started;
+					std::atomic<std::uint64_t> completed;
+					std::atomic<std::uint64_t> aborted;
+					std::atomic<std::uint64_t> bytes_in;
+					std::atomic<std::uint64_t> bytes_out;
+					std::atomic<std::uint64_t> wakeups;
+					std::atomic<std::uint64_t> actions;
+					std::atomic<std::uint64_t> timer_updates;
+					std::atomic<std::uint64_t> timer_waits;
+					std::atomic<std::uint64_t> timer_posts;
+					std::atomic<std::uint64_t> reaps;
+					std::atomic<std::uint64_t> flushes;
+					atomic_histogram name_lookup;
+					atomic_histogram connect;
+					atomic_histogram app_connect;
+					atomic_histogram start_transfer;
+					atomic_histogram total;
+
+
+					recorder (const recorder &) = delete;
+					recorder (recorder &&) = delete;
+					recorder & operator = (const recorder &) = delete;
+					recorder & operator = (recorder &&) = delete;
+
+
+					recorder () noexcept;
+
+
+					static void add (std::atomic<std::uint64_t> &, std::uint64_t=1) noexcept;
+					void record (const transfer_stats &) noexcept;
+					void snapshot (asiocurl::metrics &) const noexcept;
 
 
 			};
@@ -106,8 +542,27 @@ namespace asiocurl {
 					int what;
 					bool read;
 					bool write;
-					std::shared_ptr<bool> closed;
-					asio::ip::tcp::socket socket;
+					//	Incremented when the pending waits are cancelled so
+					//	that their handlers know to do nothing even if they
+					//	completed before they could be cancelled
+					std::size_t generation;
+					//	The events which have occurred but which have not
+					//	yet been serviced when events are batched, if this
+					//	is non-zero the socket is in ready_
+					int ready;
+					//	True if libcurl did not open this socket through
+					//	the open callback (see \ref socket), in which case
+					//	socket is a duplicate (made by dup or, on Windows,
+					//	by WSADuplicateSocket) of libcurl's descriptor
+					bool foreign;
+					slot_ptr slot;
+					//	Any family of stream socket libcurl may open (e.g.
+					//	TCP or Unix domain)
+					asio::generic::stream_protocol::socket socket;
+					//	The descriptor by which libcurl knows this socket,
+					//	for foreign sockets this is not the descriptor of
+					//	socket (which is a duplicate)
+					curl_socket_t native;
 
 
 					socket_state () = delete;
@@ -117,7 +572,8 @@ namespace asiocurl {
 					socket_state & operator = (socket_state &&) = delete;
 
 
-					socket_state (const asio::ip::tcp::socket::protocol_type &, asio::io_service &);
+					socket_state (const asio::generic::stream_protocol &, asio::io_service &, control &);
+					socket_state (curl_socket_t, asio::io_service &, control &);
 
 
 			};
@@ -127,24 +583,93 @@ namespace asiocurl {
 			native_handle_type handle_;
 			using handles_type=std::unordered_map<CURL *,easy_state>;
 			handles_type handles_;
+			std::atomic<std::size_t> size_;
 			using sockets_type=std::unordered_map<curl_socket_t,socket_state>;
 			sockets_type sockets_;
-			std::shared_ptr<control> control_;
+			control_ptr control_;
+			//	Used by the timer and by operations posted to
+			//	the strand
+			slot_ptr slot_;
 			asio::steady_timer timer_;
+			asio::steady_timer::time_point deadline_;
+			bool waiting_;
+			//	While a batch is being inserted libcurl's requests for
+			//	an immediate timeout are merely recorded and are acted
+			//	upon once when the batch is complete
+			bool batching_;
+			bool kick_;
+			//	Whether an action in response to a zero timeout has
+			//	been posted and has not yet run
+			bool posted_;
+			optional<asio::io_service::strand> strand_;
+			share * share_;
+			slab_pool slabs_;
+			//	Zero when admission is not limited
+			std::size_t max_in_flight_;
+			std::size_t in_flight_;
+			//	Transfers waiting for admission, one queue for each
+			//	priority
+			std::deque<CURL *> queues_ [3];
+			std::atomic<std::size_t> queued_;
+			bool instrument_;
+			recorder recorder_;
+			bool batch_events_;
+			class readiness {
+
+
+				public:
+
+
+					socket_state * ss;
+					slot_ref r;
+
+
+			};
+			//	Sockets which became ready since the last flush, and
+			//	those being flushed (kept so that their capacity is
+			//	reused)
+			std::vector<readiness> ready_;
+			std::vector<readiness> flushing_;
+			//	Whether a flush has been posted and has not yet run
+			bool flush_posted_;
 
 
 			static curl_socket_t open (void *, curlsocktype, struct curl_sockaddr *) noexcept;
 			static int close (void *, curl_socket_t) noexcept;
 			static int socket (CURL *, curl_socket_t, int, void *, void *) noexcept;
 			static int timer (CURLM *, long, void *) noexcept;
+			static easy_state & state (CURL *) noexcept;
 
 
-			void do_action (curl_socket_t, int);
-			void abort (easy_state &) noexcept;
+			template <typename Operation, typename Handler>
+			void async (Operation, handler_memory &, Handler);
+			slot_ref ref (const slot_ptr &) const noexcept;
+			void do_action (curl_socket_t, int) noexcept;
+			int socket_action (curl_socket_t, int, error_code &) noexcept;
+			void fail (error_code) noexcept;
+			void reap (int) noexcept;
 			void abort (handles_type::iterator) noexcept;
 			void complete (CURLMsg) noexcept;
+			void insert (CURL *, completion &, priority);
+			void start (CURL *, completion &, priority);
+			bool admit () const noexcept;
+			void promote () noexcept;
+			static completion promise_completion (promise<CURLMsg>);
+			std::vector<future<CURLMsg>> batch (std::vector<CURL *>, priority);
+			void insert_batch (const std::vector<CURL *> &, std::vector<completion> &, std::vector<bool> &, priority) noexcept;
+			void schedule ();
+			void post_action ();
+			static error_code to_error_code (std::exception_ptr) noexcept;
+			static std::exception_ptr to_exception (error_code) noexcept;
+			bool resume (CURL *) noexcept;
+			void apply (const options &);
 			void read (socket_state &);
 			void write (socket_state &);
+			static void cancel (socket_state &) noexcept;
+			int service (socket_state &, const slot_ref &, int, error_code &) noexcept;
+			void ready (socket_state &, const slot_ref &, int);
+			void flush ();
+			void wait ();
 
 
 		public:
@@ -166,8 +691,62 @@ namespace asiocurl {
 			 *		shall be associated.  This reference must remain valid
 			 *		for the lifetime of the io_service or the behaviour is
 			 *		undefined.
+			 *	\param [in] s
+			 *		The manner in which the io_service shall serialize
+			 *		access to its curl multi handle.  Defaults to
+			 *		\ref serialization::mutex.
+			 */
+			explicit io_service (asio::io_service & ios, serialization s=serialization::mutex);
+			/**
+			 *	Creates a new io_service which uses a certain
+			 *	asio::io_service for socket I/O and timeouts and which
+			 *	attaches a certain \ref share to each easy handle which
+			 *	it manages.
+			 *
+			 *	Several io_service objects which use the same \ref share
+			 *	reuse each others' DNS lookups and TLS sessions (depending
+			 *	on what the \ref share shares).
+			 *
+			 *	\param [in] ios
+			 *		See above.
+			 *	\param [in] sh
+			 *		The \ref share.  This reference must remain valid for
+			 *		the lifetime of the io_service or the behaviour is
+			 *		undefined.
+			 *	\param [in] s
+			 *		See above.
+			 */
+			io_service (asio::io_service & ios, share & sh, serialization s=serialization::mutex);
+			/**
+			 *	Creates a new io_service which uses a certain
+			 *	asio::io_service for socket I/O and timeouts and
+			 *	whose curl multi handle is configured by certain
+			 *	\ref options.
+			 *
+			 *	\param [in] ios
+			 *		See above.
+			 *	\param [in] o
+			 *		The \ref options.
+			 *	\param [in] s
+			 *		See above.
+			 */
+			io_service (asio::io_service & ios, const options & o, serialization s=serialization::mutex);
+			/**
+			 *	Creates a new io_service which attaches a certain
+			 *	\ref share to each easy handle which it manages and
+			 *	whose curl multi handle is configured by certain
+			 *	\ref options.
+			 *
+			 *	\param [in] ios
+			 *		See above.
+			 *	\param [in] sh
+			 *		See above.
+			 *	\param [in] o
+			 *		See above.
+			 *	\param [in] s
+			 *		See above.
 			 */
-			explicit io_service (asio::io_service & ios);
+			io_service (asio::io_service & ios, share & sh, const options & o, serialization s=serialization::mutex);
 
 
 			/**
@@ -204,71 +783,831 @@ namespace asiocurl {
 			 *	Doing anything else with the easy handle at this point leads to
 			 *	undefined behaviour.
 			 *
+			 *	While the easy handle is managed by the io_service its
+			 *	CURLOPT_PRIVATE option is used internally.  Retrieving
+			 *	CURLINFO_PRIVATE during this time leads to undefined
+			 *	behaviour.  The original value is restored before the
+			 *	returned future becomes ready.
+			 *
+			 *	If this io_service was created with a \ref share the easy
+			 *	handle's CURLOPT_SHARE option is set thereto while it is
+			 *	managed by the io_service and is cleared before the returned
+			 *	future becomes ready.
+			 *
+			 *	If this io_service uses \ref serialization::strand and this
+			 *	function is not called from within the strand the easy handle
+			 *	is added asynchronously.  Errors which would otherwise be
+			 *	thrown (for example when \em easy is already managed by this
+			 *	io_service) are instead reported through the returned future.
+			 *
+			 *	If the number of transfers in flight is limited (see
+			 *	\ref options::max_in_flight) and that limit has been reached
+			 *	the easy handle waits in a queue until it is admitted, it is
+			 *	nonetheless managed by the io_service (and may be removed)
+			 *	while it waits.
+			 *
 			 *	\param [in] easy
 			 *		The easy handle to add to the io_service.
+			 *	\param [in] p
+			 *		The \ref priority of the transfer.  Defaults to
+			 *		\ref priority::normal.
 			 *
 			 *	\return
 			 *		A handle to the future value of the completed transfer
 			 *		represented by the easy handle.
 			 */
-			future<CURLMsg> add (CURL * easy);
+			future<CURLMsg> add (CURL * easy, priority p=priority::normal);
 
 
 			/**
-			 *	Removes a curl easy handle from the io_service.
+			 *	Adds a curl easy handle to be managed by this io_service
+			 *	and reports its completion through a \ref oneshot_future.
 			 *
-			 *	Once this call completes the io_service will no longer
-			 *	use the easy handle.
+			 *	This function is identical to \ref add except for the type
+			 *	of the returned future.  A oneshot_future costs a single
+			 *	allocation per transfer and a continuation attached by
+			 *	oneshot_future::then runs on the thread which completes the
+			 *	transfer.  When the continuation is known when the transfer
+			 *	is added that allocation is avoided by passing it to
+			 *	submit directly.
 			 *
-			 *	Note that the io_service does not reset any options it has
-			 *	set on the easy handle.  Accordingly reusing the easy handle
-			 *	without calling curl_easy_reset on it leads to undefined behaviour
-			 *	unless the new transfer is handled through the same io_service.
+			 *	\param [in] easy
+			 *		The easy handle to add to the io_service.
+			 *	\param [in] p
+			 *		The \ref priority of the transfer.  Defaults to
+			 *		\ref priority::normal.
 			 *
-			 *	If \em easy was never added to this io_service, or if the
-			 *	transfer has completed, nothing happens.
+			 *	\return
+			 *		A handle to the future value of the completed transfer
+			 *		represented by the easy handle.
+			 */
+			oneshot_future<CURLMsg> submit (CURL * easy, priority p=priority::normal);
+			/**
+			 *	Adds a curl easy handle to be managed by this io_service
+			 *	and invokes a continuation with a ready \ref oneshot_future
+			 *	when the transfer completes.
 			 *
-			 *	Note that it is not necessary to call this function after
-			 *	a transfer completes: In this instance the easy handle is
-			 *	automatically disassociated from the io_service.
+			 *	The result is the same as attaching the continuation to the
+			 *	oneshot_future returned by the above overload by calling
+			 *	oneshot_future::then, except that no shared state is created.
+			 *	The continuation is stored with the transfer (without
+			 *	allocating memory if it is small and nothrow move
+			 *	constructible) and receives a oneshot_future which holds the
+			 *	CURLMsg (or the exception \ref add would report) itself, so
+			 *	a successful transfer allocates nothing on behalf of this
+			 *	function.
 			 *
 			 *	\param [in] easy
-			 *		The easy handle to disassociate from the io_service.
-			 *
-			 *	\return
-			 *		\em true if \em easy was disassociated from the
-			 *		io_service, \em false if \em easy was not associated
-			 *		with the io_service.
+			 *		The easy handle to add to the io_service.
+			 *	\param [in] f
+			 *		A function object which is invocable with a
+			 *		oneshot_future<CURLMsg> and which does not throw.  It
+			 *		is invoked on the thread which completes the transfer.
+			 *	\param [in] p
+			 *		The \ref priority of the transfer.  Defaults to
+			 *		\ref priority::normal.
 			 */
-			bool remove (CURL * easy) noexcept;
+			template <typename F>
+			void submit (CURL * easy, F f, priority p=priority::normal);
 
 
 			/**
-			 *	Returns the asio::io_service associated with this
-			 *	object.
+			 *	Adds a number of curl easy handles to be managed by this
+			 *	io_service.
 			 *
-			 *	This method is named get_io_service rather than io_service
-			 *	(which would be in keeping with standard library naming
-			 *	conventions) for consistency with other classes in ASIO
-			 *	which use the name get_io_service.
+			 *	The result is the same as calling \ref add for each easy
+			 *	handle except that serialization is performed once for the
+			 *	entire batch and that libcurl is prompted to begin the
+			 *	transfers once after all easy handles have been added
+			 *	rather than once per easy handle.
+			 *
+			 *	Errors which \ref add would throw (for example when an easy
+			 *	handle is already managed by this io_service) are reported
+			 *	through the future for the offending easy handle and do not
+			 *	prevent the remaining easy handles from being added.
+			 *
+			 *	\tparam Range
+			 *		A type which may be iterated with a range-based for loop
+			 *		and whose elements are convertible to CURL *, for example
+			 *		std::vector<CURL *> or std::vector<\ref easy>.
+			 *
+			 *	\param [in] easies
+			 *		The easy handles to add to the io_service.
+			 *	\param [in] p
+			 *		The \ref priority of each transfer.  Defaults to
+			 *		\ref priority::normal.
 			 *
 			 *	\return
-			 *		A reference to the associated asio::io_service.
+			 *		A handle to the future value of each completed transfer
+			 *		in the same order as \em easies.
 			 */
-			asio::io_service & get_io_service () const noexcept;
+			template <typename Range>
+			std::vector<future<CURLMsg>> add_batch (const Range & easies, priority p=priority::normal) {
+
+				std::vector<CURL *> vec;
+				for (auto && easy : easies) vec.push_back(easy);
+
+				return batch(std::move(vec),p);
+
+			}
 
 
 			/**
-			 *	Retrieves the curl multi handle this io_service object
-			 *	wraps.
+			 *	Begins performing the transfer represented by a curl easy
+			 *	handle and reports its completion through an ASIO completion
+			 *	token.
+			 *
+			 *	The requirements on the easy handle are the same as for
+			 *	\ref add, with the point at which the io_service is done
+			 *	with the easy handle being the point at which the completion
+			 *	handler is invoked.
+			 *
+			 *	The completion handler has the signature
+			 *	void (error_code, CURLMsg).  When the error_code indicates
+			 *	success the CURLMsg describes the completed transfer (note
+			 *	that the transfer itself may still have failed, see the
+			 *	CURLcode in the CURLMsg).  Otherwise the error_code is
+			 *	asio::error::operation_aborted if the transfer was removed
+			 *	or the io_service was destroyed, asio::error::already_started
+			 *	if \em easy is already managed by this io_service, or a value
+			 *	from \ref easy_category or \ref multi_category.
+			 *
+			 *	When the transfer completes the completion handler is
+			 *	dispatched through its associated executor (by default the
+			 *	executor of the associated asio::io_service) and therefore
+			 *	a plain callback is invoked directly on the thread which
+			 *	completes the transfer, in which case it must not throw.
+			 *	When the error_code indicates failure the completion handler
+			 *	is instead posted.  The completion handler is never invoked
+			 *	from within this function.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to add to the io_service.
+			 *	\param [in] token
+			 *		The completion token, for example a callback,
+			 *		asio::use_future, an asio::yield_context, or
+			 *		asio::use_awaitable.
 			 *
 			 *	\return
-			 *		A curl multi handle.
+			 *		Whatever the completion token dictates.
 			 */
-			native_handle_type native_handle () const noexcept;
+			template <typename CompletionToken>
+			auto async_perform (CURL * easy, CompletionToken && token);
+			/**
+			 *	Begins performing the transfer represented by a curl easy
+			 *	handle with a certain \ref priority and reports its
+			 *	completion through an ASIO completion token.
+			 *
+			 *	\param [in] easy
+			 *		See above.
+			 *	\param [in] p
+			 *		The \ref priority of the transfer.
+			 *	\param [in] token
+			 *		See above.
+			 *
+			 *	\return
+			 *		See above.
+			 */
+			template <typename CompletionToken>
+			auto async_perform (CURL * easy, priority p, CompletionToken && token);
 
 
-	};
+			/**
+			 *	Begins performing the transfer represented by a curl easy
+			 *	handle and reports its completion, along with its
+			 *	\ref transfer_stats, through an ASIO completion token.
+			 *
+			 *	This function is identical to \ref async_perform except
+			 *	that the completion handler has the signature
+			 *	void (error_code, CURLMsg, transfer_stats).  The statistics
+			 *	are captured on the thread which completes the transfer
+			 *	before the completion handler is dispatched.  When the
+			 *	error_code indicates failure all members of the
+			 *	transfer_stats are zero.
+			 *
+			 *	\param [in] easy
+			 *		See \ref async_perform.
+			 *	\param [in] token
+			 *		See \ref async_perform.
+			 *
+			 *	\return
+			 *		Whatever the completion token dictates.
+			 */
+			template <typename CompletionToken>
+			auto async_perform_with_stats (CURL * easy, CompletionToken && token);
+			/**
+			 *	Begins performing the transfer represented by a curl easy
+			 *	handle with a certain \ref priority and reports its
+			 *	completion, along with its \ref transfer_stats, through an
+			 *	ASIO completion token.
+			 *
+			 *	\param [in] easy
+			 *		See above.
+			 *	\param [in] p
+			 *		The \ref priority of the transfer.
+			 *	\param [in] token
+			 *		See above.
+			 *
+			 *	\return
+			 *		See above.
+			 */
+			template <typename CompletionToken>
+			auto async_perform_with_stats (CURL * easy, priority p, CompletionToken && token);
+
+
+			#ifdef ASIOCURL_HAS_COROUTINES
+			class transfer;
+
+
+			/**
+			 *	Begins performing the transfer represented by a curl easy
+			 *	handle when the returned object is awaited by a C++20
+			 *	coroutine.
+			 *
+			 *	The requirements on the easy handle are the same as for
+			 *	\ref add, with the point at which the io_service is done
+			 *	with the easy handle being the point at which the awaiting
+			 *	coroutine is resumed.
+			 *
+			 *	When the transfer completes the awaiting coroutine is
+			 *	resumed directly on the thread which completes the transfer
+			 *	and the co_await expression yields the CURLMsg which
+			 *	describes the completed transfer.  If the transfer is aborted
+			 *	or cannot be added the co_await expression throws the same
+			 *	exception which \ref add would report through its future,
+			 *	in this case the coroutine is resumed through the associated
+			 *	asio::io_service (or is not suspended at all).
+			 *
+			 *	The returned object must be awaited exactly once and is
+			 *	intended to be awaited immediately:
+			 *
+			 *	\code
+			 *	CURLMsg msg=co_await curl.perform(easy);
+			 *	\endcode
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to add to the io_service.
+			 *	\param [in] p
+			 *		The \ref priority of the transfer.  Defaults to
+			 *		\ref priority::normal.
+			 *
+			 *	\return
+			 *		An awaitable object.
+			 */
+			transfer perform (CURL * easy, priority p=priority::normal) noexcept;
+			#endif
+
+
+			/**
+			 *	Removes a curl easy handle from the io_service, after
+			 *	which the io_service no longer uses it, except that if
+			 *	this io_service uses \ref serialization::strand and this
+			 *	function is not called from within the strand the easy
+			 *	handle remains in use until the transfer is reported as
+			 *	aborted and must not be destroyed or reused before then.
+			 *
+			 *	Note that the io_service does not reset any options it has
+			 *	set on the easy handle.  Accordingly reusing the easy handle
+			 *	without calling curl_easy_reset on it leads to undefined behaviour
+			 *	unless the new transfer is handled through the same io_service.
+			 *
+			 *	If \em easy was never added to this io_service, or if the
+			 *	transfer has completed, nothing happens.
+			 *
+			 *	Note that it is not necessary to call this function after
+			 *	a transfer completes: In this instance the easy handle is
+			 *	automatically disassociated from the io_service.
+			 *
+			 *	If this io_service uses \ref serialization::strand and this
+			 *	function is not called from within the strand the easy handle
+			 *	is removed asynchronously.  In this case the io_service will
+			 *	not use the easy handle once the future returned by \ref add
+			 *	becomes ready (or the completion handler is invoked) and
+			 *	\em true is returned unless the removal could not be
+			 *	scheduled.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to disassociate from the io_service.
+			 *
+			 *	\return
+			 *		\em true if \em easy was disassociated from the
+			 *		io_service (or if its disassociation was scheduled),
+			 *		\em false if \em easy was not associated with the
+			 *		io_service (or if memory to schedule its
+			 *		disassociation could not be allocated).
+			 */
+			bool remove (CURL * easy) noexcept;
+
+
+			/**
+			 *	Resumes a transfer which was paused by one of its
+			 *	callbacks returning CURL_WRITEFUNC_PAUSE or
+			 *	CURL_READFUNC_PAUSE.
+			 *
+			 *	libcurl may invoke callbacks of the easy handle (for
+			 *	example to deliver data which arrived while the transfer
+			 *	was paused) before this function returns, therefore it
+			 *	must not be called while holding a lock which those
+			 *	callbacks acquire.
+			 *
+			 *	If resuming the transfer fails the transfer is aborted
+			 *	and the error is reported in place of its result.
+			 *
+			 *	If this io_service uses \ref serialization::strand and this
+			 *	function is not called from within the strand the transfer
+			 *	is resumed asynchronously and \em true is returned unless
+			 *	the resumption could not be scheduled.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle whose transfer shall be resumed.
+			 *
+			 *	\return
+			 *		\em true if \em easy is managed by this io_service (or if
+			 *		its resumption was scheduled), \em false otherwise
+			 *		(including if memory to schedule its resumption could
+			 *		not be allocated).
+			 */
+			bool unpause (CURL * easy) noexcept;
+
+
+			/**
+			 *	Determines the number of transfers currently managed
+			 *	by this io_service.
+			 *
+			 *	This function does not synchronize with the asynchronous
+			 *	operations of the io_service and therefore the value
+			 *	returned may be stale by the time the caller observes it.
+			 *	It is intended for use in load balancing heuristics.
+			 *
+			 *	\return
+			 *		The number of easy handles which have been added and
+			 *		which have not yet completed or been removed, including
+			 *		those waiting for admission.
+			 */
+			std::size_t size () const noexcept;
+			/**
+			 *	Determines the number of transfers which are waiting
+			 *	for admission (see \ref options::max_in_flight).
+			 *
+			 *	As with \ref size the value returned may be stale by
+			 *	the time the caller observes it.
+			 *
+			 *	\return
+			 *		The number of easy handles which have been added but
+			 *		which are not yet in the curl multi handle.
+			 */
+			std::size_t queued () const noexcept;
+			/**
+			 *	Takes a snapshot of the counters, gauges, and latency
+			 *	histograms maintained by this io_service.
+			 *
+			 *	Counters and histograms are read without synchronizing
+			 *	with the asynchronous operations of the io_service, so
+			 *	recording them costs the thread servicing the io_service
+			 *	only a few relaxed stores.  The gauges are read while
+			 *	holding the lock which serializes access to the curl
+			 *	multi handle.
+			 *
+			 *	\return
+			 *		A \ref metrics object.
+			 */
+			asiocurl::metrics metrics () const;
+
+
+			/**
+			 *	Returns the asio::io_service associated with this
+			 *	object.
+			 *
+			 *	This method is named get_io_service rather than io_service
+			 *	(which would be in keeping with standard library naming
+			 *	conventions) for consistency with other classes in ASIO
+			 *	which use the name get_io_service.
+			 *
+			 *	\return
+			 *		A reference to the associated asio::io_service.
+			 */
+			asio::io_service & get_io_service () const noexcept;
+
+
+			/**
+			 *	Retrieves the \ref slab_pool associated with this
+			 *	io_service, which is used by \ref response_sink by
+			 *	default.
+			 *
+			 *	\return
+			 *		A reference to a \ref slab_pool.
+			 */
+			slab_pool & slabs () noexcept;
+
+
+			/**
+			 *	Changes the connection limits and multiplexing behaviour
+			 *	of this io_service.
+			 *
+			 *	Transfers which are in progress are not affected, new
+			 *	limits apply as transfers next require connections.
+			 *
+			 *	\param [in] o
+			 *		The \ref options.  Disengaged members leave the
+			 *		current setting as it is.
+			 */
+			void set_options (const options & o);
+
+
+			/**
+			 *	Retrieves the curl multi handle this io_service object
+			 *	wraps.
+			 *
+			 *	\return
+			 *		A curl multi handle.
+			 */
+			native_handle_type native_handle () const noexcept;
+
+
+	};
+
+
+
+	template <typename F>
+	class io_service::completion::model<F,true> {
+
+
+		private:
+
+
+			static F & get (completion & c) noexcept {
+
+				return *static_cast<F *>(static_cast<void *>(&c.storage_));
+
+			}
+
+
+		public:
+
+
+			static void construct (completion & c, F f) noexcept {
+
+				new (&c.storage_) F(std::move(f));
+
+			}
+
+
+			static void invoke (completion & c, error_code ec, const CURLMsg & msg) {
+
+				F f(std::move(get(c)));
+				destroy(c);
+				f(ec,msg);
+
+			}
+
+
+			static void relocate (completion & from, completion & to) noexcept {
+
+				new (&to.storage_) F(std::move(get(from)));
+				destroy(from);
+
+			}
+
+
+			static void destroy (completion & c) noexcept {
+
+				get(c).~F();
+
+			}
+
+
+	};
+
+
+	template <typename F>
+	class io_service::completion::model<F,false> {
+
+
+		private:
+
+
+			static F * & get (completion & c) noexcept {
+
+				return *static_cast<F **>(static_cast<void *>(&c.storage_));
+
+			}
+
+
+		public:
+
+
+			static void construct (completion & c, F f) {
+
+				new (&c.storage_) F *(new F(std::move(f)));
+
+			}
+
+
+			static void invoke (completion & c, error_code ec, const CURLMsg & msg) {
+
+				std::unique_ptr<F> f(get(c));
+				(*f)(ec,msg);
+
+			}
+
+
+			static void relocate (completion & from, completion & to) noexcept {
+
+				new (&to.storage_) F *(get(from));
+
+			}
+
+
+			static void destroy (completion & c) noexcept {
+
+				delete get(c);
+
+			}
+
+
+	};
+
+
+	template <typename F>
+	io_service::completion::completion (F f)
+		:	invoke_(&model<F>::invoke),
+			relocate_(&model<F>::relocate),
+			destroy_(&model<F>::destroy)
+	{
+
+		model<F>::construct(*this,std::move(f));
+
+	}
+
+
+	//	Adapts a completion handler obtained from a completion
+	//	token so that it may be stored in a completion
+	template <typename Handler>
+	class io_service::token_completion {
+
+
+		private:
+
+
+			using executor_type=asio::associated_executor_t<Handler,asio::io_service::executor_type>;
+
+
+			Handler h_;
+			asio::executor_work_guard<executor_type> work_;
+
+
+		public:
+
+
+			token_completion (Handler h, asio::io_service & ios)
+				:	h_(std::move(h)),
+					work_(asio::get_associated_executor(h_,ios.get_executor()))
+			{	}
+
+
+			void operator () (error_code ec, const CURLMsg & msg) {
+
+				auto executor=work_.get_executor();
+				work_.reset();
+				//	A transfer which fails may do so from within a call
+				//	to remove or to the destructor, therefore it must
+				//	not be reported inline
+				if (ec) {
+
+					asio::post(executor,[h=std::move(h_),ec,msg] () mutable {	h(ec,msg);	});
+					return;
+
+				}
+				asio::dispatch(executor,[h=std::move(h_),msg] () mutable {	h(error_code(),msg);	});
+
+			}
+
+
+	};
+
+
+	//	As token_completion but also captures the transfer_stats
+	//	of a successful transfer before the completion handler is
+	//	dispatched, at which point the easy handle is still owned
+	//	by the io_service
+	template <typename Handler>
+	class io_service::stats_completion {
+
+
+		private:
+
+
+			using executor_type=asio::associated_executor_t<Handler,asio::io_service::executor_type>;
+
+
+			Handler h_;
+			asio::executor_work_guard<executor_type> work_;
+
+
+		public:
+
+
+			stats_completion (Handler h, asio::io_service & ios)
+				:	h_(std::move(h)),
+					work_(asio::get_associated_executor(h_,ios.get_executor()))
+			{	}
+
+
+			void operator () (error_code ec, const CURLMsg & msg) {
+
+				auto executor=work_.get_executor();
+				work_.reset();
+				if (ec) {
+
+					asio::post(executor,[h=std::move(h_),ec,msg] () mutable {	h(ec,msg,transfer_stats());	});
+					return;
+
+				}
+				asio::dispatch(executor,[h=std::move(h_),msg,stats=transfer_stats::capture(msg.easy_handle)] () mutable {	h(error_code(),msg,stats);	});
+
+			}
+
+
+	};
+
+
+	template <typename F>
+	void io_service::submit (CURL * easy, F f, priority p) {
+
+		completion c([f=std::move(f)] (error_code ec, const CURLMsg & msg) mutable {
+
+			if (ec) f(make_exceptional_oneshot_future<CURLMsg>(to_exception(ec)));
+			else f(make_ready_oneshot_future(msg));
+
+		});
+		start(easy,c,p);
+
+	}
+
+
+	template <typename CompletionToken>
+	auto io_service::async_perform (CURL * easy, CompletionToken && token) {
+
+		return async_perform(easy,priority::normal,std::forward<CompletionToken>(token));
+
+	}
+
+
+	template <typename CompletionToken>
+	auto io_service::async_perform (CURL * easy, priority p, CompletionToken && token) {
+
+		return asio::async_initiate<CompletionToken,void (error_code, CURLMsg)>([this,p] (auto handler, CURL * easy) {
+
+			completion c(token_completion<decltype(handler)>(std::move(handler),ios_));
+			try {
+
+				start(easy,c,p);
+
+			} catch (...) {
+
+				//	The completion handler must not be invoked
+				//	from within the initiating function
+				asio::post(ios_,[easy,c=std::move(c),ec=to_error_code(std::current_exception())] () mutable {
+
+					CURLMsg msg{};
+					msg.easy_handle=easy;
+					c(ec,msg);
+
+				});
+
+			}
+
+		},token,easy);
+
+	}
+
+
+	template <typename CompletionToken>
+	auto io_service::async_perform_with_stats (CURL * easy, CompletionToken && token) {
+
+		return async_perform_with_stats(easy,priority::normal,std::forward<CompletionToken>(token));
+
+	}
+
+
+	template <typename CompletionToken>
+	auto io_service::async_perform_with_stats (CURL * easy, priority p, CompletionToken && token) {
+
+		return asio::async_initiate<CompletionToken,void (error_code, CURLMsg, transfer_stats)>([this,p] (auto handler, CURL * easy) {
+
+			completion c(stats_completion<decltype(handler)>(std::move(handler),ios_));
+			try {
+
+				start(easy,c,p);
+
+			} catch (...) {
+
+				asio::post(ios_,[easy,c=std::move(c),ec=to_error_code(std::current_exception())] () mutable {
+
+					CURLMsg msg{};
+					msg.easy_handle=easy;
+					c(ec,msg);
+
+				});
+
+			}
+
+		},token,easy);
+
+	}
+
+
+	#ifdef ASIOCURL_HAS_COROUTINES
+	/**
+	 *	An awaitable object which represents a transfer started
+	 *	by \ref io_service::perform.
+	 */
+	class io_service::transfer {
+
+
+		private:
+
+
+			io_service & self_;
+			CURL * easy_;
+			priority priority_;
+			std::exception_ptr ex_;
+			error_code ec_;
+			CURLMsg msg_;
+			//	Set by whichever of completion and suspension happens
+			//	first so that the one which happens second knows that
+			//	it is responsible for continuing the coroutine
+			std::atomic<bool> flag_;
+
+
+		public:
+
+
+			transfer () = delete;
+			transfer (const transfer &) = delete;
+			transfer (transfer &&) = delete;
+			transfer & operator = (const transfer &) = delete;
+			transfer & operator = (transfer &&) = delete;
+
+
+			transfer (io_service & self, CURL * easy, priority p) noexcept : self_(self), easy_(easy), priority_(p), msg_{}, flag_(false) {	}
+
+
+			bool await_ready () const noexcept {
+
+				return false;
+
+			}
+
+
+			bool await_suspend (std::coroutine_handle<> h) {
+
+				completion c([this,h,&ios=self_.ios_] (error_code ec, const CURLMsg & msg) {
+
+					ec_=ec;
+					msg_=msg;
+					if (!flag_.exchange(true)) return;
+					//	As for async_perform a failed transfer may be
+					//	reported from within remove or the destructor
+					if (ec_) asio::post(ios,[h] () {	h.resume();	});
+					else h.resume();
+
+				});
+
+				try {
+
+					self_.start(easy_,c,priority_);
+
+				} catch (...) {
+
+					ex_=std::current_exception();
+					return false;
+
+				}
+
+				return !flag_.exchange(true);
+
+			}
+
+
+			CURLMsg await_resume () {
+
+				if (ex_) std::rethrow_exception(std::move(ex_));
+				if (ec_) std::rethrow_exception(to_exception(ec_));
+
+				return msg_;
+
+			}
+
+
+	};
+
+
+	inline io_service::transfer io_service::perform (CURL * easy, priority p) noexcept {
+
+		return transfer(*this,easy,p);
 
+	}
+	#endif
 
 }
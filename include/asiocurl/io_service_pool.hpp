@@ -0,0 +1,320 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "asio.hpp"
+#include "future.hpp"
+#include "io_service.hpp"
+#include "metrics.hpp"
+#include "oneshot.hpp"
+#include "optional.hpp"
+#include <curl/curl.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace asiocurl {
+
+
+	class share;
+
+
+	/**
+	 *	Spreads curl easy handles across a number of shards
+	 *	each of which consists of an asio::io_service, an
+	 *	\ref io_service (and therefore a curl multi handle),
+	 *	and a thread which runs the asio::io_service.
+	 *
+	 *	Since shards share no state transfers on different
+	 *	shards never contend with one another which allows
+	 *	throughput to scale with the number of shards.  Shards
+	 *	may optionally share DNS lookups and TLS sessions through
+	 *	a \ref share at the cost of contending on its locks.
+	 */
+	class io_service_pool {
+
+
+		public:
+
+
+			/**
+			 *	Determines how shards are selected when a transfer
+			 *	is added.
+			 */
+			enum class policy {
+
+				/**
+				 *	Each transfer is added to the shard after the shard
+				 *	to which the previous transfer was added.
+				 */
+				round_robin,
+				/**
+				 *	Each transfer is added to the shard which is currently
+				 *	managing the fewest transfers.
+				 */
+				least_in_flight
+
+			};
+
+
+		private:
+
+
+			class shard {
+
+
+				public:
+
+
+					asio::io_service ios;
+					io_service curl;
+					optional<asio::io_service::work> work;
+					std::thread thread;
+
+
+					shard (const shard &) = delete;
+					shard (shard &&) = delete;
+					shard & operator = (const shard &) = delete;
+					shard & operator = (shard &&) = delete;
+
+
+					shard ();
+					explicit shard (share &);
+					~shard () noexcept;
+
+
+					void start ();
+
+
+			};
+
+
+			using shards_type=std::vector<std::unique_ptr<shard>>;
+			shards_type shards_;
+			policy policy_;
+			std::atomic<std::size_t> next_;
+
+
+			shard & select () noexcept;
+			void populate (std::size_t, share *);
+
+
+		public:
+
+
+			io_service_pool () = delete;
+			io_service_pool (const io_service_pool &) = delete;
+			io_service_pool (io_service_pool &&) = delete;
+			io_service_pool & operator = (const io_service_pool &) = delete;
+			io_service_pool & operator = (io_service_pool &&) = delete;
+
+
+			/**
+			 *	Creates a new io_service_pool and starts the thread
+			 *	associated with each shard.
+			 *
+			 *	\param [in] size
+			 *		The number of shards.  Must be non-zero.
+			 *	\param [in] p
+			 *		The policy by which shards shall be selected.
+			 *		Defaults to \ref policy::round_robin.
+			 */
+			explicit io_service_pool (std::size_t size, policy p=policy::round_robin);
+			/**
+			 *	Creates a new io_service_pool whose shards share DNS
+			 *	lookups and TLS sessions (depending on what \em sh
+			 *	shares) and starts the thread associated
+			 *	with each shard.
+			 *
+			 *	\param [in] size
+			 *		See above.
+			 *	\param [in] sh
+			 *		The \ref share which each shard's \ref io_service
+			 *		attaches to the easy handles it manages.  This
+			 *		reference must remain valid for the lifetime of the
+			 *		io_service_pool or the behaviour is undefined.
+			 *	\param [in] p
+			 *		See above.
+			 */
+			io_service_pool (std::size_t size, share & sh, policy p=policy::round_robin);
+
+
+			/**
+			 *	Shuts down all shards.
+			 *
+			 *	The thread associated with each shard is stopped and
+			 *	joined and then all pending transfers are aborted.
+			 */
+			~io_service_pool () noexcept;
+
+
+			/**
+			 *	Adds a curl easy handle to one of the shards managed
+			 *	by this io_service_pool.
+			 *
+			 *	All requirements and guarantees of \ref io_service::add
+			 *	apply, except that a completed easy handle may be reused
+			 *	by adding it back to this same io_service_pool.
+			 *
+			 *	Duplicate easy handles are only detected if they happen
+			 *	to be routed to the same shard.  Adding an easy handle
+			 *	which is already managed by this io_service_pool leads
+			 *	to undefined behaviour.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to add.
+			 *
+			 *	\return
+			 *		A handle to the future value of the completed transfer
+			 *		represented by the easy handle.
+			 */
+			future<CURLMsg> add (CURL * easy);
+
+
+			/**
+			 *	Adds a curl easy handle to one of the shards managed by
+			 *	this io_service_pool.
+			 *
+			 *	See \ref io_service::submit and \ref add.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to add.
+			 *
+			 *	\return
+			 *		A handle to the future value of the completed transfer
+			 *		represented by the easy handle.
+			 */
+			oneshot_future<CURLMsg> submit (CURL * easy);
+			/**
+			 *	Adds a curl easy handle to one of the shards managed by
+			 *	this io_service_pool and invokes a continuation when the
+			 *	transfer completes.
+			 *
+			 *	See \ref io_service::submit and \ref add.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to add.
+			 *	\param [in] f
+			 *		The continuation.
+			 */
+			template <typename F>
+			void submit (CURL * easy, F f) {
+
+				select().curl.submit(easy,std::move(f));
+
+			}
+
+
+			/**
+			 *	Begins performing the transfer represented by a curl
+			 *	easy handle on one of the shards managed by this
+			 *	io_service_pool.
+			 *
+			 *	See \ref io_service::async_perform and \ref add.  Note
+			 *	that unless the completion handler has an associated
+			 *	executor it is invoked on the thread of the selected
+			 *	shard.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to add.
+			 *	\param [in] token
+			 *		The completion token.
+			 *
+			 *	\return
+			 *		Whatever the completion token dictates.
+			 */
+			template <typename CompletionToken>
+			auto async_perform (CURL * easy, CompletionToken && token) {
+
+				return select().curl.async_perform(easy,std::forward<CompletionToken>(token));
+
+			}
+
+
+			#ifdef ASIOCURL_HAS_COROUTINES
+			/**
+			 *	Begins performing the transfer represented by a curl
+			 *	easy handle on one of the shards managed by this
+			 *	io_service_pool when the returned object is awaited.
+			 *
+			 *	See \ref io_service::perform.  Note that the awaiting
+			 *	coroutine is resumed on the thread of the selected shard.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to add.
+			 *
+			 *	\return
+			 *		An awaitable object.
+			 */
+			io_service::transfer perform (CURL * easy) {
+
+				return select().curl.perform(easy);
+
+			}
+			#endif
+
+
+			/**
+			 *	Removes a curl easy handle from whichever shard is
+			 *	managing it.
+			 *
+			 *	See \ref io_service::remove.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle to disassociate from the
+			 *		io_service_pool.
+			 *
+			 *	\return
+			 *		\em true if \em easy was disassociated from the
+			 *		io_service_pool, \em false if \em easy was not
+			 *		associated with the io_service_pool.
+			 */
+			bool remove (CURL * easy) noexcept;
+
+
+			/**
+			 *	Determines the number of shards.
+			 *
+			 *	\return
+			 *		The number of shards.
+			 */
+			std::size_t size () const noexcept;
+
+
+			/**
+			 *	Takes a snapshot of the metrics of each shard (see
+			 *	\ref io_service::metrics) and merges them.
+			 *
+			 *	\return
+			 *		A \ref metrics object.
+			 */
+			asiocurl::metrics metrics () const;
+
+
+			/**
+			 *	Retrieves the \ref io_service associated with a
+			 *	certain shard.
+			 *
+			 *	\param [in] i
+			 *		The index of the shard.  Must be less than the
+			 *		value returned by \ref size or the behaviour is
+			 *		undefined.
+			 *
+			 *	\return
+			 *		A reference to an io_service.
+			 */
+			io_service & operator [] (std::size_t i) noexcept;
+
+
+	};
+
+
+}
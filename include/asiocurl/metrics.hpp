@@ -0,0 +1,169 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "histogram.hpp"
+#include <cstddef>
+#include <cstdint>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	A snapshot of the counters, gauges, and latency histograms
+	 *	maintained by an \ref io_service.
+	 *
+	 *	Counters and histograms accumulate over the lifetime of the
+	 *	io_service.  Gauges reflect the moment at which the snapshot
+	 *	was taken.
+	 */
+	class metrics {
+
+
+		public:
+
+
+			/**
+			 *	The number of transfers which were added.
+			 */
+			std::uint64_t started;
+			/**
+			 *	The number of transfers which libcurl reported as
+			 *	done, successfully or otherwise.
+			 */
+			std::uint64_t completed;
+			/**
+			 *	The number of transfers which were removed,
+			 *	failed to start, or were abandoned when the
+			 *	io_service was destroyed.
+			 */
+			std::uint64_t aborted;
+			/**
+			 *	The number of bytes downloaded by completed transfers.
+			 *	Only maintained when instrumentation is enabled (see
+			 *	\ref io_service::options::instrument).
+			 */
+			std::uint64_t bytes_in;
+			/**
+			 *	The number of bytes uploaded by completed transfers.
+			 *	Only maintained when instrumentation is enabled.
+			 */
+			std::uint64_t bytes_out;
+			/**
+			 *	The number of times a socket became ready and the
+			 *	io_service woke up to service it.
+			 */
+			std::uint64_t wakeups;
+			/**
+			 *	The number of calls to curl_multi_socket_action, both
+			 *	in response to socket readiness and to timeouts.
+			 */
+			std::uint64_t actions;
+			/**
+			 *	The number of times libcurl changed its timeout.
+			 */
+			std::uint64_t timer_updates;
+			/**
+			 *	The number of times the timer was started (or
+			 *	restarted) in response to those changes.
+			 */
+			std::uint64_t timer_waits;
+			/**
+			 *	The number of times an action was posted in response
+			 *	to libcurl requesting that its timeout expire
+			 *	immediately.
+			 */
+			std::uint64_t timer_posts;
+			/**
+			 *	The number of times transfers libcurl had finished
+			 *	were collected through curl_multi_info_read.  This is
+			 *	skipped after actions which did not reduce the number
+			 *	of running transfers.
+			 */
+			std::uint64_t reaps;
+			/**
+			 *	The number of times the socket events which occurred
+			 *	during a pass of the reactor were acted upon together
+			 *	(see \ref io_service::options::batch_events).
+			 */
+			std::uint64_t flushes;
+			/**
+			 *	The number of sockets open at the time of the
+			 *	snapshot.
+			 */
+			std::size_t sockets;
+			/**
+			 *	The number of transfers being managed at the time of
+			 *	the snapshot, including those waiting for admission.
+			 */
+			std::size_t handles;
+			/**
+			 *	The number of transfers in the curl multi handle at
+			 *	the time of the snapshot.
+			 */
+			std::size_t in_flight;
+			/**
+			 *	The number of transfers waiting for admission at the
+			 *	time of the snapshot.
+			 */
+			std::size_t queued;
+			/**
+			 *	The latency of name resolution of completed transfers
+			 *	(see \ref transfer_stats::name_lookup).  Only maintained
+			 *	when instrumentation is enabled, as are the histograms
+			 *	which follow.
+			 */
+			histogram name_lookup;
+			/**
+			 *	The latency until the connection was established.
+			 */
+			histogram connect;
+			/**
+			 *	The latency until the TLS handshake completed.
+			 */
+			histogram app_connect;
+			/**
+			 *	The latency until the first byte of the response
+			 *	was received.
+			 */
+			histogram start_transfer;
+			/**
+			 *	The duration of completed transfers.
+			 */
+			histogram total;
+
+
+			/**
+			 *	Creates a metrics object all of whose counters and
+			 *	gauges are zero and all of whose histograms are
+			 *	empty.
+			 */
+			metrics () noexcept;
+
+
+			/**
+			 *	Combines another snapshot with this one.
+			 *
+			 *	Counters and gauges are summed and histograms are
+			 *	merged, so that the snapshots of several io_service
+			 *	objects (for example the shards of an
+			 *	\ref io_service_pool) may be aggregated.
+			 *
+			 *	\param [in] other
+			 *		The other snapshot.
+			 *
+			 *	\return
+			 *		A reference to this object.
+			 */
+			metrics & merge (const metrics & other) noexcept;
+
+
+	};
+
+
+}
@@ -0,0 +1,606 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "optional.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace asiocurl {
+
+
+	template <typename T>
+	class oneshot_future;
+	template <typename T>
+	class oneshot_promise;
+	template <typename T>
+	oneshot_future<T> make_ready_oneshot_future (T);
+	template <typename T>
+	oneshot_future<T> make_exceptional_oneshot_future (std::exception_ptr);
+
+
+	//	The state shared by a oneshot_promise and a oneshot_future
+	//
+	//	All transitions are made by atomically setting bits in a single
+	//	state word, the mutex and condition variable are only used when
+	//	a thread actually blocks waiting for the value
+	template <typename T>
+	class oneshot_state {
+
+
+		template <typename>
+		friend class oneshot_future;
+		template <typename>
+		friend class oneshot_promise;
+
+
+		private:
+
+
+			static constexpr unsigned ready=1;
+			static constexpr unsigned continuation=2;
+			static constexpr unsigned waiting=4;
+
+
+			using storage_type=std::aligned_storage<64,alignof(std::max_align_t)>::type;
+
+
+			std::atomic<unsigned> flags_;
+			std::atomic<unsigned> refs_;
+			optional<T> value_;
+			std::exception_ptr ex_;
+			std::mutex m_;
+			std::condition_variable cv_;
+			storage_type storage_;
+			void (*invoke_) (oneshot_state &) noexcept;
+
+
+			oneshot_state () noexcept : flags_(0), refs_(1), invoke_(nullptr) {	}
+
+
+			void acquire () noexcept {
+
+				refs_.fetch_add(1,std::memory_order_relaxed);
+
+			}
+
+
+			void release () noexcept {
+
+				if (refs_.fetch_sub(1,std::memory_order_acq_rel)==1) delete this;
+
+			}
+
+
+			bool is_ready () const noexcept {
+
+				return (flags_.load(std::memory_order_acquire)&ready)!=0;
+
+			}
+
+
+			void set () noexcept {
+
+				auto prev=flags_.fetch_or(ready,std::memory_order_acq_rel);
+				if ((prev&waiting)!=0) {
+
+					{	std::lock_guard<std::mutex> l(m_);	}
+					cv_.notify_all();
+
+				}
+				if ((prev&continuation)!=0) invoke_(*this);
+
+			}
+
+
+			void wait () noexcept {
+
+				if (is_ready()) return;
+
+				std::unique_lock<std::mutex> l(m_);
+				if ((flags_.fetch_or(waiting,std::memory_order_acq_rel)&ready)!=0) return;
+				cv_.wait(l,[&] () noexcept {	return is_ready();	});
+
+			}
+
+
+			template <typename F>
+			static constexpr bool is_inline () noexcept {
+
+				return (sizeof(F)<=sizeof(storage_type)) && std::is_nothrow_move_constructible<F>::value;
+
+			}
+
+
+			//	Invoking a continuation transfers the reference held by
+			//	the future to which it was attached to the future which
+			//	it receives
+			template <typename F>
+			static void invoke_inline (oneshot_state & s) noexcept {
+
+				auto & f=*static_cast<F *>(static_cast<void *>(&s.storage_));
+				F local(std::move(f));
+				f.~F();
+				local(oneshot_future<T>(&s));
+
+			}
+
+
+			template <typename F>
+			static void invoke_allocated (oneshot_state & s) noexcept {
+
+				std::unique_ptr<F> f(*static_cast<F **>(static_cast<void *>(&s.storage_)));
+				(*f)(oneshot_future<T>(&s));
+
+			}
+
+
+			template <typename F>
+			void store (F f) {
+
+				if (is_inline<F>()) {
+
+					new (&storage_) F(std::move(f));
+					invoke_=&invoke_inline<F>;
+
+				} else {
+
+					new (&storage_) F *(new F(std::move(f)));
+					invoke_=&invoke_allocated<F>;
+
+				}
+
+			}
+
+
+			void arm () noexcept {
+
+				//	Whichever of the promise and the future sets its bit
+				//	second is responsible for invoking the continuation
+				if ((flags_.fetch_or(continuation,std::memory_order_acq_rel)&ready)!=0) invoke_(*this);
+
+			}
+
+
+	};
+
+
+	/**
+	 *	A handle to a value which will be provided by a
+	 *	\ref oneshot_promise.
+	 *
+	 *	Unlike asiocurl::future this class does not allocate beyond
+	 *	the single shared state created by the promise, does not
+	 *	acquire a lock unless a thread blocks in \ref get or \ref wait,
+	 *	and supports attaching a single continuation which is invoked
+	 *	on the thread which provides the value.
+	 *
+	 *	A oneshot_future which is ready from the outset (see
+	 *	\ref make_ready_oneshot_future) holds its value itself
+	 *	and has no shared state at all.
+	 *
+	 *	\tparam T
+	 *		The type of the value.
+	 */
+	template <typename T>
+	class oneshot_future {
+
+
+		template <typename>
+		friend class oneshot_promise;
+		template <typename>
+		friend class oneshot_state;
+		template <typename U>
+		friend oneshot_future<U> make_ready_oneshot_future (U);
+		template <typename U>
+		friend oneshot_future<U> make_exceptional_oneshot_future (std::exception_ptr);
+
+
+		private:
+
+
+			oneshot_state<T> * state_;
+			//	The value (or exception) of a oneshot_future which was
+			//	created ready and which therefore has no shared state
+			optional<T> value_;
+			std::exception_ptr ex_;
+
+
+			explicit oneshot_future (oneshot_state<T> * state) noexcept : state_(state) {	}
+
+
+			//	Whether this object holds its value itself
+			bool is_inline () const noexcept {
+
+				return value_ || ex_;
+
+			}
+
+
+			oneshot_state<T> & state () const {
+
+				if (!state_) throw std::future_error(std::future_errc::no_state);
+
+				return *state_;
+
+			}
+
+
+			T take () {
+
+				oneshot_future f(std::move(*this));
+				if (f.ex_) std::rethrow_exception(f.ex_);
+
+				return std::move(*f.value_);
+
+			}
+
+
+		public:
+
+
+			oneshot_future (const oneshot_future &) = delete;
+			oneshot_future & operator = (const oneshot_future &) = delete;
+
+
+			/**
+			 *	Creates a oneshot_future which does not refer to a
+			 *	shared state.
+			 */
+			oneshot_future () noexcept : state_(nullptr) {	}
+
+
+			oneshot_future (oneshot_future && rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+				:	state_(rhs.state_),
+					value_(std::move(rhs.value_)),
+					ex_(std::move(rhs.ex_))
+			{
+
+				rhs.state_=nullptr;
+				rhs.value_=nullopt;
+
+			}
+
+
+			oneshot_future & operator = (oneshot_future && rhs) noexcept(std::is_nothrow_move_assignable<T>::value && std::is_nothrow_move_constructible<T>::value) {
+
+				if (this==&rhs) return *this;
+
+				if (state_) state_->release();
+				state_=rhs.state_;
+				rhs.state_=nullptr;
+				value_=std::move(rhs.value_);
+				rhs.value_=nullopt;
+				ex_=std::move(rhs.ex_);
+
+				return *this;
+
+			}
+
+
+			~oneshot_future () noexcept {
+
+				if (state_) state_->release();
+
+			}
+
+
+			/**
+			 *	Determines whether this object refers to a shared
+			 *	state.
+			 *
+			 *	\return
+			 *		\em true if it does, \em false otherwise.
+			 */
+			bool valid () const noexcept {
+
+				return (state_!=nullptr) || is_inline();
+
+			}
+
+
+			/**
+			 *	Determines whether the value (or an exception) has
+			 *	been provided.
+			 *
+			 *	\return
+			 *		\em true if it has, \em false otherwise.
+			 */
+			bool is_ready () const {
+
+				if (is_inline()) return true;
+
+				return state().is_ready();
+
+			}
+
+
+			/**
+			 *	Blocks until the value (or an exception) has been
+			 *	provided.
+			 */
+			void wait () const {
+
+				if (is_inline()) return;
+
+				state().wait();
+
+			}
+
+
+			/**
+			 *	Blocks until the value (or an exception) has been
+			 *	provided and then retrieves it.
+			 *
+			 *	After this call this object no longer refers to a
+			 *	shared state.
+			 *
+			 *	\return
+			 *		The value.
+			 */
+			T get () {
+
+				if (is_inline()) return take();
+
+				auto & s=state();
+				s.wait();
+				oneshot_future f(std::move(*this));
+				if (s.ex_) std::rethrow_exception(s.ex_);
+
+				return std::move(*s.value_);
+
+			}
+
+
+			/**
+			 *	Attaches a continuation which is invoked with a ready
+			 *	oneshot_future once the value (or an exception) has
+			 *	been provided.
+			 *
+			 *	If the value has already been provided the continuation
+			 *	is invoked immediately, otherwise it is invoked on the
+			 *	thread which provides the value.  Small continuations
+			 *	are stored within the shared state and therefore attaching
+			 *	them does not allocate memory.
+			 *
+			 *	After this call this object no longer refers to a
+			 *	shared state.
+			 *
+			 *	\param [in] f
+			 *		A function object which is invocable with a
+			 *		oneshot_future and which does not throw.
+			 */
+			template <typename F>
+			void then (F f) {
+
+				if (is_inline()) {
+
+					f(std::move(*this));
+					return;
+
+				}
+
+				auto & s=state();
+				if (s.is_ready()) {
+
+					f(std::move(*this));
+					return;
+
+				}
+
+				s.store(std::move(f));
+				//	The reference held by this object now belongs
+				//	to the continuation
+				state_=nullptr;
+				s.arm();
+
+			}
+
+
+	};
+
+
+	/**
+	 *	Provides a value to a single \ref oneshot_future.
+	 *
+	 *	\tparam T
+	 *		The type of the value.
+	 */
+	template <typename T>
+	class oneshot_promise {
+
+
+		private:
+
+
+			oneshot_state<T> * state_;
+			bool retrieved_;
+
+
+			void abandon () noexcept {
+
+				if (!state_) return;
+
+				if (!state_->is_ready()) set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+				state_->release();
+
+			}
+
+
+			oneshot_state<T> & state () const {
+
+				if (!state_) throw std::future_error(std::future_errc::no_state);
+
+				return *state_;
+
+			}
+
+
+		public:
+
+
+			oneshot_promise (const oneshot_promise &) = delete;
+			oneshot_promise & operator = (const oneshot_promise &) = delete;
+
+
+			/**
+			 *	Creates a oneshot_promise and its shared state.
+			 */
+			oneshot_promise () : state_(new oneshot_state<T>()), retrieved_(false) {	}
+
+
+			oneshot_promise (oneshot_promise && rhs) noexcept : state_(rhs.state_), retrieved_(rhs.retrieved_) {
+
+				rhs.state_=nullptr;
+
+			}
+
+
+			oneshot_promise & operator = (oneshot_promise && rhs) noexcept {
+
+				if (this==&rhs) return *this;
+
+				abandon();
+				state_=rhs.state_;
+				retrieved_=rhs.retrieved_;
+				rhs.state_=nullptr;
+
+				return *this;
+
+			}
+
+
+			/**
+			 *	If no value has been provided the associated
+			 *	oneshot_future becomes ready with a std::future_error.
+			 */
+			~oneshot_promise () noexcept {
+
+				abandon();
+
+			}
+
+
+			/**
+			 *	Retrieves the oneshot_future associated with this
+			 *	object.  May only be called once.
+			 *
+			 *	\return
+			 *		A oneshot_future.
+			 */
+			oneshot_future<T> get_future () {
+
+				auto & s=state();
+				if (retrieved_) throw std::future_error(std::future_errc::future_already_retrieved);
+				retrieved_=true;
+				s.acquire();
+
+				return oneshot_future<T>(&s);
+
+			}
+
+
+			/**
+			 *	Provides the value.
+			 *
+			 *	If a continuation is attached to the associated
+			 *	oneshot_future it is invoked before this function
+			 *	returns.
+			 *
+			 *	\param [in] value
+			 *		The value.
+			 */
+			void set_value (T value) {
+
+				auto & s=state();
+				if (s.is_ready()) throw std::future_error(std::future_errc::promise_already_satisfied);
+				s.value_.emplace(std::move(value));
+				s.set();
+
+			}
+
+
+			/**
+			 *	Provides an exception in place of the value.
+			 *
+			 *	\param [in] ex
+			 *		The exception.
+			 */
+			void set_exception (std::exception_ptr ex) {
+
+				auto & s=state();
+				if (s.is_ready()) throw std::future_error(std::future_errc::promise_already_satisfied);
+				s.ex_=std::move(ex);
+				s.set();
+
+			}
+
+
+	};
+
+
+	/**
+	 *	Creates a \ref oneshot_future which is ready with a certain
+	 *	value.
+	 *
+	 *	The returned object holds the value itself and therefore
+	 *	creating it does not allocate memory.
+	 *
+	 *	\tparam T
+	 *		The type of the value.
+	 *
+	 *	\param [in] value
+	 *		The value.
+	 *
+	 *	\return
+	 *		A ready oneshot_future.
+	 */
+	template <typename T>
+	oneshot_future<T> make_ready_oneshot_future (T value) {
+
+		oneshot_future<T> retr;
+		retr.value_.emplace(std::move(value));
+
+		return retr;
+
+	}
+
+
+	/**
+	 *	Creates a \ref oneshot_future which is ready with a certain
+	 *	exception.
+	 *
+	 *	\tparam T
+	 *		The type of the value.
+	 *
+	 *	\param [in] ex
+	 *		The exception, must not be null.
+	 *
+	 *	\return
+	 *		A ready oneshot_future.
+	 */
+	template <typename T>
+	oneshot_future<T> make_exceptional_oneshot_future (std::exception_ptr ex) {
+
+		oneshot_future<T> retr;
+		retr.ex_=std::move(ex);
+
+		return retr;
+
+	}
+
+
+}
@@ -0,0 +1,153 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "asio.hpp"
+#include "io_service.hpp"
+#include "slab_pool.hpp"
+#include <curl/curl.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	Collects the response body of a transfer into a chain of
+	 *	slabs obtained from a \ref slab_pool (by default the pool
+	 *	of the \ref io_service which performs the transfer).
+	 *
+	 *	If the response carries a Content-Length the number of slabs
+	 *	it requires (up to a limit) is obtained all at once when the
+	 *	body begins to arrive rather than one at a time.
+	 *
+	 *	The slabs are returned to the pool when the lifetime of
+	 *	this object ends or when \ref clear is called.
+	 */
+	class response_sink {
+
+
+		public:
+
+
+			/**
+			 *	The type of the ASIO ConstBufferSequence which
+			 *	represents the collected body.
+			 */
+			using const_buffers_type=std::vector<asio::const_buffer>;
+
+
+		private:
+
+
+			static std::size_t write (char *, std::size_t, std::size_t, void *) noexcept;
+
+
+			slab_pool::state_ptr pool_;
+			CURL * easy_;
+			std::size_t max_reserve_;
+			bool started_;
+			//	Each slab in use, the size of each buffer is the
+			//	number of bytes of that slab which are used
+			const_buffers_type chain_;
+			std::vector<char *> slabs_;
+			//	Slabs obtained in advance but not yet used
+			std::vector<char *> spare_;
+			std::size_t size_;
+
+
+			void reserve (std::size_t);
+			void append (const char *, std::size_t);
+
+
+		public:
+
+
+			response_sink () = delete;
+			response_sink (const response_sink &) = delete;
+			response_sink (response_sink &&) = delete;
+			response_sink & operator = (const response_sink &) = delete;
+			response_sink & operator = (response_sink &&) = delete;
+
+
+			/**
+			 *	Sets CURLOPT_WRITEFUNCTION and CURLOPT_WRITEDATA on
+			 *	an easy handle so that its response body is collected
+			 *	by this object.
+			 *
+			 *	This object must remain valid until the transfer
+			 *	completes or the behaviour is undefined.
+			 *
+			 *	\param [in] pool
+			 *		The pool from which slabs shall be obtained.
+			 *	\param [in] easy
+			 *		The easy handle.
+			 *	\param [in] max_reserve
+			 *		The largest Content-Length for which slabs are obtained
+			 *		in advance, larger bodies obtain slabs as they arrive.
+			 *		Defaults to 1 MiB.
+			 */
+			response_sink (slab_pool & pool, CURL * easy, std::size_t max_reserve=1024*1024);
+			/**
+			 *	Sets CURLOPT_WRITEFUNCTION and CURLOPT_WRITEDATA on
+			 *	an easy handle so that its response body is collected
+			 *	by this object using the \ref slab_pool of an
+			 *	\ref io_service.
+			 *
+			 *	\param [in] curl
+			 *		The io_service whose slab_pool shall be used.
+			 *	\param [in] easy
+			 *		See above.
+			 *	\param [in] max_reserve
+			 *		See above.
+			 */
+			response_sink (io_service & curl, CURL * easy, std::size_t max_reserve=1024*1024);
+
+
+			/**
+			 *	Returns all slabs to the pool.
+			 */
+			~response_sink () noexcept;
+
+
+			/**
+			 *	Retrieves the collected body.
+			 *
+			 *	\return
+			 *		A ConstBufferSequence which remains valid until this
+			 *		object is modified.
+			 */
+			const const_buffers_type & data () const noexcept;
+			/**
+			 *	Determines the size of the collected body.
+			 *
+			 *	\return
+			 *		A number of bytes.
+			 */
+			std::size_t size () const noexcept;
+			/**
+			 *	Copies the collected body into a std::string.
+			 *
+			 *	\return
+			 *		A std::string.
+			 */
+			std::string str () const;
+
+
+			/**
+			 *	Discards the collected body and returns all slabs to
+			 *	the pool so that the easy handle may be reused.
+			 */
+			void clear () noexcept;
+
+
+	};
+
+
+}
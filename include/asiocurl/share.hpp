@@ -0,0 +1,129 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include <curl/curl.h>
+#include <initializer_list>
+#include <shared_mutex>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	An RAII wrapper for a curl share handle which allows DNS
+	 *	lookups, TLS sessions, et cetera to be shared between easy
+	 *	handles even when those easy handles are managed by different
+	 *	multi handles (and therefore different \ref io_service objects)
+	 *	on different threads.
+	 *
+	 *	Connections (CURL_LOCK_DATA_CONNECT) must not be shared
+	 *	between different \ref io_service objects: Each \ref io_service
+	 *	owns the sockets of the connections it opens and libcurl does
+	 *	not support sharing connections between concurrent threads.
+	 *
+	 *	Each type of shared data is protected by its own reader/writer
+	 *	lock so that (for example) a DNS lookup on one thread does not
+	 *	contend with a TLS session being stored on another.
+	 */
+	class share {
+
+
+		public:
+
+
+			/**
+			 *	The type of the underlying curl share handle.
+			 */
+			using native_handle_type=CURLSH *;
+
+
+		private:
+
+
+			class lock {
+
+
+				public:
+
+
+					std::shared_mutex m;
+					//	Only written and read by the thread which holds
+					//	m exclusively, shared holders always observe
+					//	false
+					bool exclusive;
+
+
+					lock () noexcept : exclusive(false) {	}
+
+
+			};
+
+
+			static void lock_function (CURL *, curl_lock_data, curl_lock_access, void *) noexcept;
+			static void unlock_function (CURL *, curl_lock_data, void *) noexcept;
+
+
+			native_handle_type handle_;
+			lock locks_ [CURL_LOCK_DATA_LAST];
+
+
+		public:
+
+
+			share (const share &) = delete;
+			share (share &&) = delete;
+			share & operator = (const share &) = delete;
+			share & operator = (share &&) = delete;
+
+
+			/**
+			 *	Creates a share which shares DNS lookups and TLS
+			 *	sessions.
+			 */
+			share ();
+			/**
+			 *	Creates a share which shares certain types of data.
+			 *
+			 *	\param [in] data
+			 *		The types of data to share, each of which is
+			 *		passed to curl_share_setopt with CURLSHOPT_SHARE.
+			 */
+			explicit share (std::initializer_list<curl_lock_data> data);
+
+
+			/**
+			 *	Calls curl_share_cleanup.
+			 *
+			 *	No easy handle may be using the share when its lifetime
+			 *	ends or the behaviour is undefined.
+			 */
+			~share () noexcept;
+
+
+			/**
+			 *	Retrieves the managed curl share handle.
+			 *
+			 *	\return
+			 *		A curl share handle.
+			 */
+			native_handle_type native_handle () const noexcept;
+			/**
+			 *	Retrieves the managed curl share handle, allowing
+			 *	this object to be used as a drop-in replacement
+			 *	for a raw curl share handle.
+			 *
+			 *	\return
+			 *		A curl share handle.
+			 */
+			operator native_handle_type () const noexcept;
+
+
+	};
+
+
+}
@@ -0,0 +1,114 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace asiocurl {
+
+
+	class response_sink;
+
+
+	/**
+	 *	A thread safe pool of fixed-size blocks of memory ("slabs")
+	 *	which are recycled rather than being returned to the
+	 *	allocator.
+	 *
+	 *	Slabs obtained from a slab_pool may outlive it: The
+	 *	memory is released once the pool and all slabs obtained
+	 *	from it are gone.
+	 */
+	class slab_pool {
+
+
+		friend class response_sink;
+
+
+		private:
+
+
+			class state {
+
+
+				public:
+
+
+					std::mutex m;
+					std::vector<char *> idle;
+					std::size_t slab_size;
+					std::size_t max_idle;
+
+
+					state (std::size_t, std::size_t);
+					state (const state &) = delete;
+					state (state &&) = delete;
+					state & operator = (const state &) = delete;
+					state & operator = (state &&) = delete;
+					~state () noexcept;
+
+
+					//	Appends n slabs to the vector
+					void acquire (std::size_t n, std::vector<char *> &);
+					//	Empties the vector
+					void release (std::vector<char *> &) noexcept;
+
+
+			};
+
+
+			using state_ptr=std::shared_ptr<state>;
+			state_ptr state_;
+
+
+		public:
+
+
+			slab_pool (const slab_pool &) = delete;
+			slab_pool (slab_pool &&) = delete;
+			slab_pool & operator = (const slab_pool &) = delete;
+			slab_pool & operator = (slab_pool &&) = delete;
+
+
+			/**
+			 *	Creates a slab_pool.
+			 *
+			 *	\param [in] slab_size
+			 *		The size of each slab in bytes.  Defaults to 4096.
+			 *	\param [in] max_idle
+			 *		The maximum number of slabs which the pool retains
+			 *		while they are not in use, slabs returned while this
+			 *		many are idle are freed.  Defaults to 1024.
+			 */
+			explicit slab_pool (std::size_t slab_size=4096, std::size_t max_idle=1024);
+
+
+			/**
+			 *	Retrieves the size of each slab.
+			 *
+			 *	\return
+			 *		A number of bytes.
+			 */
+			std::size_t slab_size () const noexcept;
+			/**
+			 *	Determines the number of idle slabs.
+			 *
+			 *	\return
+			 *		The number of slabs which have been returned to the
+			 *		pool and which have not yet been reused.
+			 */
+			std::size_t idle () const noexcept;
+
+
+	};
+
+
+}
@@ -0,0 +1,104 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include <curl/curl.h>
+#include <chrono>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	A summary of the timing and size of a completed transfer
+	 *	as reported by curl_easy_getinfo.
+	 *
+	 *	All durations are measured from the beginning of the
+	 *	transfer.  Phases which did not take place (for example TLS
+	 *	negotiation for a plain HTTP transfer or connection setup
+	 *	when a connection was reused) are zero.
+	 */
+	class transfer_stats {
+
+
+		public:
+
+
+			/**
+			 *	The time until name resolution completed
+			 *	(CURLINFO_NAMELOOKUP_TIME_T).
+			 */
+			std::chrono::microseconds name_lookup;
+			/**
+			 *	The time until the connection to the remote host
+			 *	or proxy was established (CURLINFO_CONNECT_TIME_T).
+			 */
+			std::chrono::microseconds connect;
+			/**
+			 *	The time until the TLS (or other) handshake completed
+			 *	(CURLINFO_APPCONNECT_TIME_T).
+			 */
+			std::chrono::microseconds app_connect;
+			/**
+			 *	The time until the first byte of the response was
+			 *	received (CURLINFO_STARTTRANSFER_TIME_T).
+			 */
+			std::chrono::microseconds start_transfer;
+			/**
+			 *	The duration of the entire transfer
+			 *	(CURLINFO_TOTAL_TIME_T).
+			 */
+			std::chrono::microseconds total;
+			/**
+			 *	The number of bytes downloaded
+			 *	(CURLINFO_SIZE_DOWNLOAD_T).
+			 */
+			curl_off_t downloaded;
+			/**
+			 *	The number of bytes uploaded
+			 *	(CURLINFO_SIZE_UPLOAD_T).
+			 */
+			curl_off_t uploaded;
+			/**
+			 *	The last response code received
+			 *	(CURLINFO_RESPONSE_CODE).
+			 */
+			long response_code;
+			/**
+			 *	\em true if the transfer did not need to open a new
+			 *	connection (i.e. CURLINFO_NUM_CONNECTS was zero).
+			 */
+			bool reused;
+
+
+			/**
+			 *	Creates a transfer_stats object all of whose members
+			 *	are zero.
+			 */
+			transfer_stats () noexcept;
+
+
+			/**
+			 *	Retrieves the statistics of the transfer most recently
+			 *	performed by an easy handle.
+			 *
+			 *	Information which libcurl cannot provide is left as
+			 *	zero.
+			 *
+			 *	\param [in] easy
+			 *		The easy handle.
+			 *
+			 *	\return
+			 *		A transfer_stats object.
+			 */
+			static transfer_stats capture (CURL * easy) noexcept;
+
+
+	};
+
+
+}
@@ -0,0 +1,215 @@
+/**
+ *	\file
+ */
+
+
+#pragma once
+
+
+#include "asio.hpp"
+#include "io_service.hpp"
+#include <curl/curl.h>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+
+namespace asiocurl {
+
+
+	/**
+	 *	Supplies the request body of a transfer performed through
+	 *	an \ref io_service from ASIO const buffer sequences.
+	 *
+	 *	The buffers are not copied: libcurl's read callback copies
+	 *	directly from the memory they refer to into libcurl's upload
+	 *	buffer.  The memory must therefore remain valid until it has
+	 *	been consumed, which may be guaranteed either by keeping it
+	 *	alive until the transfer completes or by supplying an owner
+	 *	(a std::shared_ptr) which is released once the buffers it
+	 *	owns have been consumed.
+	 *
+	 *	A producer which is still generating data may append buffers
+	 *	with \ref write while the transfer is in progress and must
+	 *	call \ref close once it is done.  Should libcurl consume all
+	 *	the data appended so far the transfer is paused (by returning
+	 *	CURL_READFUNC_PAUSE from the read callback) until more is
+	 *	appended or the upload is closed.
+	 *
+	 *	The upload cannot be rewound, accordingly transfers which
+	 *	must resend the request body (for example due to redirects
+	 *	or authentication negotiation) fail.
+	 */
+	class upload {
+
+
+		private:
+
+
+			class chunk {
+
+
+				public:
+
+
+					asio::const_buffer buffer;
+					std::shared_ptr<const void> owner;
+
+
+			};
+
+
+			mutable std::mutex m_;
+			io_service & curl_;
+			CURL * easy_;
+			std::deque<chunk> chunks_;
+			std::size_t offset_;
+			std::size_t size_;
+			bool closed_;
+			bool paused_;
+
+
+			static std::size_t read (char *, std::size_t, std::size_t, void *) noexcept;
+
+
+			void check () const;
+			void resume (std::unique_lock<std::mutex> &) noexcept;
+
+
+			template <typename ConstBufferSequence>
+			void append (const ConstBufferSequence & buffers, const std::shared_ptr<const void> & owner) {
+
+				for (auto begin=asio::buffer_sequence_begin(buffers),end=asio::buffer_sequence_end(buffers);begin!=end;++begin) {
+
+					asio::const_buffer b(*begin);
+					if (b.size()==0) continue;
+					chunks_.push_back(chunk{b,owner});
+					size_+=b.size();
+
+				}
+
+			}
+
+
+			void set_size ();
+
+
+		public:
+
+
+			upload () = delete;
+			upload (const upload &) = delete;
+			upload (upload &&) = delete;
+			upload & operator = (const upload &) = delete;
+			upload & operator = (upload &&) = delete;
+
+
+			/**
+			 *	Sets CURLOPT_READFUNCTION and CURLOPT_READDATA on an easy
+			 *	handle so that its request body is supplied by buffers
+			 *	subsequently passed to \ref write.
+			 *
+			 *	Since the size of the request body is not known libcurl
+			 *	uses chunked transfer encoding for HTTP/1.1 uploads.
+			 *
+			 *	The caller remains responsible for selecting the kind of
+			 *	upload (for example by setting CURLOPT_UPLOAD or
+			 *	CURLOPT_POST) and for adding the easy handle to \em curl.
+			 *	This object must remain valid until the transfer
+			 *	completes or the behaviour is undefined.
+			 *
+			 *	\param [in] curl
+			 *		The io_service which shall perform the transfer.
+			 *	\param [in] easy
+			 *		The easy handle which represents the transfer.
+			 */
+			upload (io_service & curl, CURL * easy);
+			/**
+			 *	Sets CURLOPT_READFUNCTION and CURLOPT_READDATA on an easy
+			 *	handle so that its request body is a certain const buffer
+			 *	sequence, and sets CURLOPT_INFILESIZE_LARGE and
+			 *	CURLOPT_POSTFIELDSIZE_LARGE to its size.
+			 *
+			 *	The upload is closed, see above for further details.
+			 *
+			 *	\param [in] curl
+			 *		See above.
+			 *	\param [in] easy
+			 *		See above.
+			 *	\param [in] buffers
+			 *		The request body.  The memory to which the buffers
+			 *		refer must remain valid until the transfer completes.
+			 */
+			template <typename ConstBufferSequence>
+			upload (io_service & curl, CURL * easy, const ConstBufferSequence & buffers) : upload(curl,easy) {
+
+				append(buffers,nullptr);
+				closed_=true;
+				set_size();
+
+			}
+
+
+			/**
+			 *	Appends buffers to the request body.
+			 *
+			 *	\param [in] buffers
+			 *		The buffers to append.
+			 *	\param [in] owner
+			 *		An object which owns the memory to which \em buffers
+			 *		refer, if any.  It is released once all of that memory
+			 *		has been consumed.  Releasing it must not call into this
+			 *		object.  If this is null the memory must remain valid
+			 *		until the transfer completes.
+			 */
+			template <typename ConstBufferSequence>
+			void write (const ConstBufferSequence & buffers, std::shared_ptr<const void> owner=nullptr) {
+
+				std::unique_lock<std::mutex> l(m_);
+				check();
+				append(buffers,owner);
+				resume(l);
+
+			}
+			/**
+			 *	Appends the contents of a reference counted contiguous
+			 *	container (for example a std::string or std::vector) to
+			 *	the request body.
+			 *
+			 *	\param [in] ptr
+			 *		A pointer to the container, which is released once its
+			 *		contents have been consumed.
+			 */
+			template <typename T>
+			void write (std::shared_ptr<T> ptr) {
+
+				auto b=asio::buffer(*ptr);
+				write(b,std::shared_ptr<const void>(std::move(ptr)));
+
+			}
+
+
+			/**
+			 *	Indicates that no further buffers will be appended, once
+			 *	all buffers appended so far have been consumed the request
+			 *	body ends.
+			 */
+			void close ();
+
+
+			/**
+			 *	Determines how many bytes of the request body have been
+			 *	appended but not yet consumed.
+			 *
+			 *	\return
+			 *		A number of bytes.
+			 */
+			std::size_t pending () const noexcept;
+
+
+	};
+
+
+}
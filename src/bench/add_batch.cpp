@@ -0,0 +1,82 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//	Measures the time taken to submit --handles (by default 10000)
+//	easy handles to an asiocurl::io_service one at a time through
+//	asiocurl::io_service::add and all at once through
+//	asiocurl::io_service::add_batch, only submission is timed, the
+//	transfers are then allowed to complete before the next round
+
+
+static void drain (std::vector<asiocurl::future<CURLMsg>> & futures) {
+
+	for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto n=args.get("handles",10000);
+	auto rounds=args.get("rounds",5);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server;
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<n;++i) handles.push_back(bench::make_easy(server.url()));
+
+	asiocurl::asio::io_service ios;
+	asiocurl::io_service curl(ios);
+	bench::threads t(ios,1);
+	//	Establish connections
+	bench::run(curl,handles,handles.size());
+
+	double add=0;
+	double batch=0;
+	for (std::size_t i=0;i<rounds;++i) {
+
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		futures.reserve(handles.size());
+		bench::stopwatch a;
+		for (auto && easy : handles) futures.push_back(curl.add(easy));
+		add+=a.seconds();
+		drain(futures);
+
+		bench::stopwatch b;
+		futures=curl.add_batch(handles);
+		batch+=b.seconds();
+		drain(futures);
+
+	}
+
+	for (auto mode : {"add","add_batch"}) {
+
+		auto seconds=((mode==std::string("add")) ? add : batch)/rounds;
+		bench::report("add_batch")
+			("mode",mode)
+			("handles",n)
+			("rounds",rounds)
+			("seconds",seconds)
+			("microseconds_per_handle",(seconds*1000000)/n);
+
+	}
+
+	return 0;
+
+}
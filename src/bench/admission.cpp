@@ -0,0 +1,167 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//	Adds --background (by default 10000) loopback transfers of --body
+//	(by default 512) bytes at once and then, while they are in progress,
+//	adds --probes (by default 100) further transfers one every
+//	--interval (by default 1) milliseconds and reports the latency of
+//	those probes
+//
+//	-	unbounded: Every transfer is added to the curl multi handle
+//		immediately and so the probes contend with the entire backlog
+//	-	admission: At most --in-flight (by default 64) transfers are
+//		in flight, the backlog is added at low priority and the probes
+//		at high priority
+
+
+namespace {
+
+
+	using clock=std::chrono::steady_clock;
+
+
+	class recorder {
+
+
+		private:
+
+
+			std::mutex m_;
+			std::vector<double> latencies_;
+			bench::latch latch_;
+
+
+		public:
+
+
+			explicit recorder (std::size_t n) : latch_(n) {
+
+				latencies_.reserve(n);
+
+			}
+
+
+			void record (asiocurl::error_code ec, const CURLMsg & msg, clock::time_point start) {
+
+				if (ec || (msg.data.result!=CURLE_OK)) throw std::runtime_error("Transfer failed");
+				{
+
+					std::lock_guard<std::mutex> l(m_);
+					latencies_.push_back(std::chrono::duration<double,std::milli>(clock::now()-start).count());
+
+				}
+				latch_.count_down();
+
+			}
+
+
+			std::vector<double> wait () {
+
+				latch_.wait();
+				std::sort(latencies_.begin(),latencies_.end());
+
+				return latencies_;
+
+			}
+
+
+	};
+
+
+	double percentile (const std::vector<double> & sorted, double p) {
+
+		auto i=static_cast<std::size_t>(p*static_cast<double>(sorted.size()-1));
+
+		return sorted[i];
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto background=args.get("background",10000);
+	auto probes=args.get("probes",100);
+	auto interval=args.get("interval",1);
+	auto in_flight=args.get("in-flight",64);
+	auto body=args.get("body",512);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server(4);
+	auto url=server.url("/bytes/"+std::to_string(body));
+
+	for (const char * mode : {"unbounded","admission"}) {
+
+		bool admission=mode==std::string("admission");
+		std::vector<asiocurl::easy> backlog;
+		backlog.reserve(background);
+		for (std::size_t i=0;i<background;++i) backlog.push_back(bench::make_easy(url));
+		std::vector<asiocurl::easy> probing;
+		probing.reserve(probes);
+		for (std::size_t i=0;i<probes;++i) probing.push_back(bench::make_easy(url));
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service::options o;
+		if (admission) o.max_in_flight=in_flight;
+		asiocurl::io_service curl(ios,o);
+		bench::threads t(ios,1);
+
+		recorder background_latency(background);
+		recorder probe_latency(probes);
+		bench::stopwatch sw;
+		auto start=clock::now();
+		for (auto && easy : backlog) curl.async_perform(easy,admission ? asiocurl::io_service::priority::low : asiocurl::io_service::priority::normal,[&,start] (auto ec, auto msg) {
+
+			background_latency.record(ec,msg,start);
+
+		});
+		for (auto && easy : probing) {
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+			curl.async_perform(easy,admission ? asiocurl::io_service::priority::high : asiocurl::io_service::priority::normal,[&,start=clock::now()] (auto ec, auto msg) {
+
+				probe_latency.record(ec,msg,start);
+
+			});
+
+		}
+		auto p=probe_latency.wait();
+		background_latency.wait();
+		auto seconds=sw.seconds();
+
+		bench::report("admission")
+			("mode",mode)
+			("background",background)
+			("probes",probes)
+			("in_flight",admission ? in_flight : background+probes)
+			("seconds",seconds)
+			("probe_p50_ms",percentile(p,0.5))
+			("probe_p99_ms",percentile(p,0.99))
+			("probe_max_ms",p.back());
+
+	}
+
+	return 0;
+
+}
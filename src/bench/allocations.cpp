@@ -0,0 +1,57 @@
+#include "allocations.hpp"
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+static std::atomic<std::size_t> count(0);
+
+
+std::size_t allocations () noexcept {
+
+	return count.load();
+
+}
+
+
+void * operator new (std::size_t size) {
+
+	count.fetch_add(1,std::memory_order_relaxed);
+	if (size==0) size=1;
+	if (auto retr=std::malloc(size)) return retr;
+	throw std::bad_alloc{};
+
+}
+
+
+void * operator new (std::size_t size, const std::nothrow_t &) noexcept {
+
+	count.fetch_add(1,std::memory_order_relaxed);
+	if (size==0) size=1;
+	return std::malloc(size);
+
+}
+
+
+void operator delete (void * ptr) noexcept {
+
+	std::free(ptr);
+
+}
+
+
+void operator delete (void * ptr, std::size_t) noexcept {
+
+	std::free(ptr);
+
+}
+
+
+void operator delete (void * ptr, const std::nothrow_t &) noexcept {
+
+	std::free(ptr);
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+
+#include <cstddef>
+
+
+//	Returns the number of allocations made through the global
+//	operator new by all threads since the program began
+//
+//	The replacement operator new lives in its own translation unit
+//	so that the compiler cannot see that it calls std::malloc where
+//	it is called (and therefore warn that the pointer is released
+//	by operator delete rather than std::free)
+std::size_t allocations () noexcept;
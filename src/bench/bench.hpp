@@ -0,0 +1,453 @@
+#pragma once
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/optional.hpp>
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#ifndef _WIN32
+#include <pthread.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <fstream>
+#endif
+
+
+namespace bench {
+
+
+	/**
+	 *	Parses command line arguments of the form --name=value.
+	 */
+	class arguments {
+
+
+		private:
+
+
+			std::map<std::string,std::string> map_;
+
+
+		public:
+
+
+			arguments (int argc, char ** argv) {
+
+				for (int i=1;i<argc;++i) {
+
+					std::string arg(argv[i]);
+					if (arg.compare(0,2,"--")!=0) continue;
+					auto eq=arg.find('=');
+					if (eq==std::string::npos) map_[arg.substr(2)]="1";
+					else map_[arg.substr(2,eq-2)]=arg.substr(eq+1);
+
+				}
+
+			}
+
+
+			std::size_t get (const std::string & name, std::size_t def) const {
+
+				auto iter=map_.find(name);
+				if (iter==map_.end()) return def;
+				return std::strtoull(iter->second.c_str(),nullptr,10);
+
+			}
+
+
+			std::string get (const std::string & name, const std::string & def) const {
+
+				auto iter=map_.find(name);
+				if (iter==map_.end()) return def;
+				return iter->second;
+
+			}
+
+
+			/**
+			 *	Retrieves a comma separated list of numbers, for
+			 *	example --concurrency=1,10,100.
+			 */
+			std::vector<std::size_t> list (const std::string & name, const std::string & def) const {
+
+				std::vector<std::size_t> retr;
+				std::istringstream ss(get(name,def));
+				std::string item;
+				while (std::getline(ss,item,',')) if (!item.empty()) retr.push_back(std::strtoull(item.c_str(),nullptr,10));
+
+				return retr;
+
+			}
+
+
+	};
+
+
+	/**
+	 *	Accumulates the parameters and results of a single
+	 *	benchmark run and writes them to standard output as a
+	 *	single line when its lifetime ends.
+	 *
+	 *	Each line is a JSON object whose "benchmark" member is
+	 *	the name of the benchmark, so that the output of many
+	 *	runs may be collected into a JSON Lines file and compared.
+	 */
+	class report {
+
+
+		private:
+
+
+			std::ostringstream ss_;
+
+
+			void string (const std::string & str) {
+
+				ss_ << '"';
+				for (auto c : str) {
+
+					if ((c=='"') || (c=='\\')) ss_ << '\\' << c;
+					else if (static_cast<unsigned char>(c)<0x20) ss_ << ' ';
+					else ss_ << c;
+
+				}
+				ss_ << '"';
+
+			}
+
+
+			template <typename T>
+			void value (const T & v) {
+
+				if constexpr (std::is_same<T,bool>::value) {
+
+					ss_ << (v ? "true" : "false");
+
+				} else if constexpr (std::is_floating_point<T>::value) {
+
+					if (std::isfinite(v)) ss_ << v;
+					else ss_ << "null";
+
+				} else if constexpr (std::is_arithmetic<T>::value) {
+
+					ss_ << v;
+
+				} else {
+
+					std::ostringstream ss;
+					ss << v;
+					string(ss.str());
+
+				}
+
+			}
+
+
+		public:
+
+
+			report (const report &) = delete;
+			report (report &&) = delete;
+			report & operator = (const report &) = delete;
+			report & operator = (report &&) = delete;
+
+
+			explicit report (const std::string & name) {
+
+				ss_ << "{\"benchmark\":";
+				string(name);
+
+			}
+
+
+			~report () noexcept {
+
+				try {
+
+					std::cout << ss_.str() << '}' << std::endl;
+
+				} catch (...) {	}
+
+			}
+
+
+			template <typename T>
+			report & operator () (const char * key, const T & value) {
+
+				ss_ << ',';
+				string(key);
+				ss_ << ':';
+				this->value(value);
+
+				return *this;
+
+			}
+
+
+	};
+
+
+	class stopwatch {
+
+
+		private:
+
+
+			using clock=std::chrono::steady_clock;
+			clock::time_point start_;
+
+
+		public:
+
+
+			stopwatch () : start_(clock::now()) {	}
+
+
+			double seconds () const {
+
+				return std::chrono::duration<double>(clock::now()-start_).count();
+
+			}
+
+
+	};
+
+
+	/**
+	 *	Determines the CPU time consumed by this process.
+	 *
+	 *	\return
+	 *		A number of seconds of user and system time, or zero
+	 *		if this information is not available on this platform.
+	 */
+	inline double cpu_seconds () noexcept {
+
+		#ifndef _WIN32
+		rusage usage;
+		if (getrusage(RUSAGE_SELF,&usage)!=0) return 0;
+		auto seconds=[] (const timeval & tv) {	return static_cast<double>(tv.tv_sec)+(static_cast<double>(tv.tv_usec)/1e6);	};
+		return seconds(usage.ru_utime)+seconds(usage.ru_stime);
+		#else
+		return 0;
+		#endif
+
+	}
+
+
+	/**
+	 *	Determines the CPU time consumed by a certain thread.
+	 *
+	 *	\return
+	 *		A number of seconds, or zero if this information is not
+	 *		available on this platform.
+	 */
+	inline double cpu_seconds (std::thread & t) noexcept {
+
+		#ifdef __linux__
+		clockid_t clock;
+		timespec ts;
+		if (pthread_getcpuclockid(t.native_handle(),&clock)!=0) return 0;
+		if (clock_gettime(clock,&ts)!=0) return 0;
+		return static_cast<double>(ts.tv_sec)+(static_cast<double>(ts.tv_nsec)/1e9);
+		#else
+		static_cast<void>(t);
+		return 0;
+		#endif
+
+	}
+
+
+	/**
+	 *	Allows one thread to wait until a number of events have
+	 *	occurred on other threads.
+	 */
+	class latch {
+
+
+		private:
+
+
+			std::atomic<std::size_t> remaining_;
+			std::promise<void> promise_;
+
+
+		public:
+
+
+			explicit latch (std::size_t n) : remaining_(n) {	}
+
+
+			void count_down () {
+
+				if (--remaining_==0) promise_.set_value();
+
+			}
+
+
+			void wait () {
+
+				promise_.get_future().get();
+
+			}
+
+
+	};
+
+
+	template <typename T>
+	void set (CURL * easy, CURLoption option, T param) {
+
+		auto result=curl_easy_setopt(easy,option,param);
+		if (result!=CURLE_OK) throw asiocurl::easy_error(result);
+
+	}
+
+
+	inline std::size_t discard (char *, std::size_t size, std::size_t nmemb, void *) noexcept {
+
+		return size*nmemb;
+
+	}
+
+
+	inline asiocurl::easy make_easy (const std::string & url) {
+
+		asiocurl::easy retr;
+		set(retr,CURLOPT_URL,url.c_str());
+		set(retr,CURLOPT_WRITEFUNCTION,&discard);
+
+		return retr;
+
+	}
+
+
+	/**
+	 *	Raises the limit on open file descriptors as far as
+	 *	possible so that benchmarks may hold many connections
+	 *	open simultaneously.
+	 */
+	inline void raise_descriptor_limit () noexcept {
+
+		#ifndef _WIN32
+		rlimit limit;
+		if (getrlimit(RLIMIT_NOFILE,&limit)!=0) return;
+		limit.rlim_cur=limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE,&limit);
+		#endif
+
+	}
+
+
+	/**
+	 *	Determines the amount of memory currently resident in
+	 *	the process.
+	 *
+	 *	\return
+	 *		A number of bytes, or zero if this information is not
+	 *		available on this platform.
+	 */
+	inline std::size_t resident_bytes () {
+
+		#ifdef __linux__
+		std::ifstream statm("/proc/self/statm");
+		std::size_t size=0;
+		std::size_t resident=0;
+		if (statm >> size >> resident) return resident*static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		#endif
+
+		return 0;
+
+	}
+
+
+	/**
+	 *	Runs an asio::io_service on a number of threads for
+	 *	as long as it exists.
+	 */
+	class threads {
+
+
+		private:
+
+
+			asiocurl::asio::io_service & ios_;
+			asiocurl::optional<asiocurl::asio::io_service::work> work_;
+			std::vector<std::thread> threads_;
+
+
+		public:
+
+
+			threads (const threads &) = delete;
+			threads (threads &&) = delete;
+			threads & operator = (const threads &) = delete;
+			threads & operator = (threads &&) = delete;
+
+
+			threads (asiocurl::asio::io_service & ios, std::size_t n) : ios_(ios), work_(asiocurl::in_place,ios) {
+
+				for (std::size_t i=0;i<n;++i) threads_.emplace_back([&ios] () noexcept {	ios.run();	});
+
+			}
+
+
+			~threads () noexcept {
+
+				work_=asiocurl::nullopt;
+				ios_.stop();
+				for (auto && t : threads_) t.join();
+
+			}
+
+
+	};
+
+
+	/**
+	 *	Performs at least \em transfers transfers by repeatedly
+	 *	adding every handle in \em handles to \em curl and waiting
+	 *	for all of them to complete.
+	 *
+	 *	\return
+	 *		The number of seconds which elapsed.
+	 */
+	template <typename Curl>
+	double run (Curl & curl, std::vector<asiocurl::easy> & handles, std::size_t transfers) {
+
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		futures.reserve(handles.size());
+
+		stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=handles.size()) {
+
+			futures.clear();
+			for (auto && easy : handles) futures.push_back(curl.add(easy));
+			for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+
+		}
+
+		return sw.seconds();
+
+	}
+
+
+}
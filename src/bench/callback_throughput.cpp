@@ -0,0 +1,54 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <sstream>
+#include <vector>
+
+
+//	Drives --concurrency (by default 10000) simultaneous transfers
+//	through a single asiocurl::io_service so that the cost of the
+//	socket callback and readiness handlers dominates
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto concurrency=args.get("concurrency",10000);
+	auto rounds=args.get("rounds",5);
+	auto size=args.get("size",16*1024);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server;
+
+	std::ostringstream path;
+	path << "/bytes/" << size;
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(server.url(path.str())));
+
+	asiocurl::asio::io_service ios;
+	asiocurl::io_service curl(ios);
+	bench::threads t(ios,1);
+	//	Establish connections
+	bench::run(curl,handles,handles.size());
+	auto transfers=handles.size()*rounds;
+	auto seconds=bench::run(curl,handles,transfers);
+
+	bench::report("callback_throughput")
+		("concurrency",concurrency)
+		("size",size)
+		("transfers",transfers)
+		("seconds",seconds)
+		("transfers_per_second",transfers/seconds)
+		("bytes_per_second",(transfers*size)/seconds);
+
+	return 0;
+
+}
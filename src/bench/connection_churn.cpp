@@ -0,0 +1,54 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <vector>
+
+
+//	Performs --transfers (by default 20000) short transfers with
+//	--concurrency (by default 64) in flight at once, each of which
+//	opens and closes its own connection, so that the cost of setting
+//	up and tearing down per socket state dominates
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto transfers=args.get("transfers",20000);
+	auto concurrency=args.get("concurrency",64);
+	auto threads=args.get("threads",1);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server;
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) {
+
+		handles.push_back(bench::make_easy(server.url()));
+		bench::set(handles.back(),CURLOPT_FORBID_REUSE,1L);
+
+	}
+
+	asiocurl::asio::io_service ios;
+	asiocurl::io_service curl(ios);
+	bench::threads t(ios,threads);
+	bench::run(curl,handles,handles.size());
+	auto seconds=bench::run(curl,handles,transfers);
+
+	bench::report("connection_churn")
+		("threads",threads)
+		("concurrency",concurrency)
+		("transfers",transfers)
+		("seconds",seconds)
+		("connections_per_second",transfers/seconds);
+
+	return 0;
+
+}
@@ -0,0 +1,215 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//	Compares --concurrency (by default 50000) simultaneous transfers
+//	awaited by C++20 coroutines through asiocurl::io_service::perform
+//	with the same number of transfers waited on through the futures
+//	returned by asiocurl::io_service::add
+//
+//	--mode selects coroutine (the default) or future, each mode should
+//	be run in a separate process so that the resident memory measured
+//	at the point when all transfers are in flight is not skewed by memory
+//	the other mode returned to the allocator
+
+
+#ifdef ASIOCURL_HAS_COROUTINES
+
+
+namespace {
+
+
+	using clock_type=std::chrono::steady_clock;
+
+
+	class task {
+
+
+		public:
+
+
+			class promise_type {
+
+
+				public:
+
+
+					task get_return_object () noexcept {
+
+						return task{};
+
+					}
+
+
+					std::suspend_never initial_suspend () noexcept {
+
+						return {};
+
+					}
+
+
+					std::suspend_never final_suspend () noexcept {
+
+						return {};
+
+					}
+
+
+					void return_void () noexcept {	}
+
+
+					void unhandled_exception () noexcept {
+
+						std::terminate();
+
+					}
+
+
+			};
+
+
+	};
+
+
+	task transfer (asiocurl::io_service & curl, CURL * easy, clock_type::duration & latency, std::atomic<std::size_t> & failures, bench::latch & l) {
+
+		auto start=clock_type::now();
+		auto msg=co_await curl.perform(easy);
+		latency=clock_type::now()-start;
+		if (msg.data.result!=CURLE_OK) ++failures;
+		l.count_down();
+
+	}
+
+
+	std::size_t run_coroutines (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::vector<clock_type::duration> & latencies) {
+
+		std::atomic<std::size_t> failures(0);
+		bench::latch l(handles.size());
+		for (std::size_t i=0;i<handles.size();++i) transfer(curl,handles[i],latencies[i],failures,l);
+		auto retr=bench::resident_bytes();
+		l.wait();
+		if (failures!=0) throw std::runtime_error("Transfer failed");
+
+		return retr;
+
+	}
+
+
+	std::size_t run_futures (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::vector<clock_type::duration> & latencies) {
+
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		std::vector<clock_type::time_point> starts;
+		futures.reserve(handles.size());
+		starts.reserve(handles.size());
+		for (auto && easy : handles) {
+
+			starts.push_back(clock_type::now());
+			futures.push_back(curl.add(easy));
+
+		}
+		auto retr=bench::resident_bytes();
+		for (std::size_t i=0;i<futures.size();++i) {
+
+			if (futures[i].get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+			latencies[i]=clock_type::now()-starts[i];
+
+		}
+
+		return retr;
+
+	}
+
+
+	double microseconds (clock_type::duration d) {
+
+		return std::chrono::duration<double,std::micro>(d).count();
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto concurrency=args.get("concurrency",50000);
+	auto size=args.get("size",1024);
+	auto mode=args.get("mode",std::string("coroutine"));
+	if ((mode!="coroutine") && (mode!="future")) {
+
+		std::cerr << "--mode must be coroutine or future" << std::endl;
+		return 1;
+
+	}
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server;
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(server.url("/bytes/"+std::to_string(size))));
+	std::vector<clock_type::duration> latencies(handles.size());
+
+	asiocurl::asio::io_service ios;
+	asiocurl::io_service curl(ios);
+	bench::threads t(ios,1);
+
+	auto before=bench::resident_bytes();
+	bench::stopwatch sw;
+	auto peak=(mode=="coroutine") ? run_coroutines(curl,handles,latencies) : run_futures(curl,handles,latencies);
+	auto seconds=sw.seconds();
+	auto in_flight=(peak>before) ? (peak-before) : 0;
+
+	std::sort(latencies.begin(),latencies.end());
+	clock_type::duration total(0);
+	for (auto && latency : latencies) total+=latency;
+
+	bench::report("coroutine")
+		("mode",mode)
+		("concurrency",concurrency)
+		("size",size)
+		("seconds",seconds)
+		("in_flight_bytes",in_flight)
+		("in_flight_bytes_per_transfer",in_flight/concurrency)
+		("mean_latency_us",microseconds(total)/latencies.size())
+		("p50_latency_us",microseconds(latencies[latencies.size()/2]))
+		("p99_latency_us",microseconds(latencies[(latencies.size()*99)/100]))
+		("max_latency_us",microseconds(latencies.back()));
+
+	return 0;
+
+}
+
+
+#else
+
+
+int main () {
+
+	std::cerr << "bench_coroutine requires a compiler which supports C++20 coroutines" << std::endl;
+
+	return 1;
+
+}
+
+
+#endif
@@ -0,0 +1,115 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/easy_pool.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//	Performs --transfers (by default 100000) keep-alive loopback
+//	transfers with --concurrency (by default 64) in flight at once,
+//	obtaining a configured easy handle for every transfer either by
+//	creating and configuring a new one (fresh) or by acquiring one
+//	from an asiocurl::easy_pool (pooled)
+//
+//	Both modes reuse connections since libcurl keeps them in the
+//	multi handle, so the difference is only the cost of creating
+//	and configuring easy handles
+
+
+namespace {
+
+
+	template <typename Acquire>
+	double run (asiocurl::io_service & curl, std::size_t concurrency, std::size_t transfers, Acquire acquire) {
+
+		using handle_type=decltype(acquire());
+		std::vector<handle_type> handles;
+		handles.reserve(concurrency);
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		futures.reserve(concurrency);
+
+		bench::stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=concurrency) {
+
+			handles.clear();
+			futures.clear();
+			for (std::size_t i=0;i<concurrency;++i) {
+
+				handles.push_back(acquire());
+				futures.push_back(curl.add(handles.back()));
+
+			}
+			for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+
+		}
+		handles.clear();
+
+		return sw.seconds();
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto concurrency=args.get("concurrency",64);
+	auto transfers=args.get("transfers",100000);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server;
+	auto url=server.url();
+
+	for (const char * mode : {"fresh","pooled"}) {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		bench::threads t(ios,1);
+		asiocurl::easy_pool pool(concurrency,[&] (asiocurl::easy & e) {
+
+			bench::set(e,CURLOPT_URL,url.c_str());
+			bench::set(e,CURLOPT_WRITEFUNCTION,&bench::discard);
+
+		});
+
+		double seconds;
+		if (mode==std::string("fresh")) {
+
+			auto acquire=[&] () {	return bench::make_easy(url);	};
+			//	Warm up connection cache
+			run(curl,concurrency,concurrency,acquire);
+			seconds=run(curl,concurrency,transfers,acquire);
+
+		} else {
+
+			auto acquire=[&] () {	return pool.acquire();	};
+			run(curl,concurrency,concurrency,acquire);
+			seconds=run(curl,concurrency,transfers,acquire);
+
+		}
+
+		bench::report("easy_pool")
+			("mode",mode)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("seconds",seconds)
+			("requests_per_second",transfers/seconds);
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,178 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/oneshot.hpp>
+#include <curl/curl.h>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//	Measures the per-transfer cost of each way of learning that a
+//	transfer completed by repeatedly performing --concurrency (by
+//	default 64) small loopback transfers until --transfers (by default
+//	100000) have been performed:
+//
+//	-	future: asiocurl::io_service::add and asiocurl::future::get
+//	-	oneshot: asiocurl::io_service::submit and asiocurl::oneshot_future::get
+//	-	then: asiocurl::io_service::submit and asiocurl::oneshot_future::then
+//	-	continuation: asiocurl::io_service::submit with a continuation
+//	-	callback: asiocurl::io_service::async_perform with a callback
+
+
+namespace {
+
+
+	template <typename Start>
+	double run_continuations (std::vector<asiocurl::easy> & handles, std::size_t transfers, Start start) {
+
+		std::atomic<std::size_t> failures(0);
+		bench::stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=handles.size()) {
+
+			bench::latch l(handles.size());
+			for (auto && easy : handles) start(easy,l,failures);
+			l.wait();
+
+		}
+		if (failures!=0) throw std::runtime_error("Transfer failed");
+
+		return sw.seconds();
+
+	}
+
+
+	double run_oneshot (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::size_t transfers) {
+
+		std::vector<asiocurl::oneshot_future<CURLMsg>> futures;
+		futures.reserve(handles.size());
+
+		bench::stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=handles.size()) {
+
+			futures.clear();
+			for (auto && easy : handles) futures.push_back(curl.submit(easy));
+			for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+
+		}
+
+		return sw.seconds();
+
+	}
+
+
+	double run_then (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::size_t transfers) {
+
+		return run_continuations(handles,transfers,[&] (CURL * easy, bench::latch & l, std::atomic<std::size_t> & failures) {
+
+			curl.submit(easy).then([&] (asiocurl::oneshot_future<CURLMsg> f) noexcept {
+
+				try {
+
+					if (f.get().data.result!=CURLE_OK) ++failures;
+
+				} catch (...) {
+
+					++failures;
+
+				}
+				l.count_down();
+
+			});
+
+		});
+
+	}
+
+
+	double run_continuation (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::size_t transfers) {
+
+		return run_continuations(handles,transfers,[&] (CURL * easy, bench::latch & l, std::atomic<std::size_t> & failures) {
+
+			curl.submit(easy,[&] (asiocurl::oneshot_future<CURLMsg> f) noexcept {
+
+				try {
+
+					if (f.get().data.result!=CURLE_OK) ++failures;
+
+				} catch (...) {
+
+					++failures;
+
+				}
+				l.count_down();
+
+			});
+
+		});
+
+	}
+
+
+	double run_callback (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::size_t transfers) {
+
+		return run_continuations(handles,transfers,[&] (CURL * easy, bench::latch & l, std::atomic<std::size_t> & failures) {
+
+			curl.async_perform(easy,[&] (auto ec, auto msg) {
+
+				if (ec || (msg.data.result!=CURLE_OK)) ++failures;
+				l.count_down();
+
+			});
+
+		});
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto concurrency=args.get("concurrency",64);
+	auto transfers=args.get("transfers",100000);
+
+	asiocurl::init init;
+	bench::server server;
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(server.url()));
+
+	for (const char * mode : {"future","oneshot","then","continuation","callback"}) {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		bench::threads t(ios,1);
+		//	Warm up connection cache
+		bench::run(curl,handles,handles.size());
+
+		double seconds;
+		std::string m(mode);
+		if (m=="future") seconds=bench::run(curl,handles,transfers);
+		else if (m=="oneshot") seconds=run_oneshot(curl,handles,transfers);
+		else if (m=="then") seconds=run_then(curl,handles,transfers);
+		else if (m=="continuation") seconds=run_continuation(curl,handles,transfers);
+		else seconds=run_callback(curl,handles,transfers);
+
+		bench::report("future_overhead")
+			("mode",mode)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("seconds",seconds)
+			("microseconds_per_transfer",(seconds*1000000)/transfers);
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,323 @@
+#include "h2_server.hpp"
+
+
+#include "bench.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/optional.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+
+namespace bench {
+
+
+	namespace asio=asiocurl::asio;
+
+
+	namespace {
+
+
+		enum : std::uint8_t {
+
+			data_frame=0x0,
+			headers_frame=0x1,
+			settings_frame=0x4,
+			ping_frame=0x6,
+			goaway_frame=0x7
+
+		};
+
+
+		enum : std::uint8_t {
+
+			end_stream=0x1,
+			ack=0x1,
+			end_headers=0x4
+
+		};
+
+
+		const std::string preface("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n");
+		const std::size_t frame_header_size=9;
+		//	The default SETTINGS_MAX_FRAME_SIZE
+		const std::size_t max_frame_size=16384;
+
+
+		class connection : public std::enable_shared_from_this<connection> {
+
+
+			private:
+
+
+				asio::ip::tcp::socket socket_;
+				asio::streambuf buffer_;
+				bool settings_;
+				bool preface_;
+				std::size_t body_;
+				//	Frames waiting for the current write to finish
+				std::string pending_;
+				std::string writing_;
+
+
+				void frame (std::uint8_t type, std::uint8_t flags, std::uint32_t stream, const char * payload, std::size_t size) {
+
+					char header [frame_header_size]={
+						static_cast<char>((size>>16)&0xFF),
+						static_cast<char>((size>>8)&0xFF),
+						static_cast<char>(size&0xFF),
+						static_cast<char>(type),
+						static_cast<char>(flags),
+						static_cast<char>((stream>>24)&0x7F),
+						static_cast<char>((stream>>16)&0xFF),
+						static_cast<char>((stream>>8)&0xFF),
+						static_cast<char>(stream&0xFF)
+					};
+					pending_.append(header,sizeof(header));
+					if (size!=0) pending_.append(payload,size);
+
+				}
+
+
+				void respond (std::uint32_t stream) {
+
+					//	:status: 200 is entry 8 of the HPACK static table,
+					//	content-length (entry 28) is sent as a literal
+					//	without indexing
+					std::string block("\x88\x0f\x0d",3);
+					auto length=std::to_string(body_);
+					block.push_back(static_cast<char>(length.size()));
+					block+=length;
+					frame(headers_frame,(body_==0) ? (end_headers|end_stream) : end_headers,stream,block.data(),block.size());
+
+					static const std::string filler(max_frame_size,'x');
+					for (auto remaining=body_;remaining!=0;) {
+
+						auto n=std::min(remaining,filler.size());
+						remaining-=n;
+						frame(data_frame,(remaining==0) ? end_stream : 0,stream,filler.data(),n);
+
+					}
+
+				}
+
+
+				void flush () {
+
+					if (!writing_.empty() || pending_.empty()) return;
+
+					std::swap(writing_,pending_);
+					asio::async_write(socket_,asio::buffer(writing_),[self=shared_from_this()] (const auto & ec, auto) {
+
+						if (ec) return;
+						self->writing_.clear();
+						self->flush();
+
+					});
+
+				}
+
+
+				void settings () {
+
+					//	The server's connection preface is a SETTINGS frame
+					frame(settings_frame,0,0,nullptr,0);
+					settings_=true;
+
+				}
+
+
+				bool process () {
+
+					while (!preface_) {
+
+						auto begin=asio::buffers_begin(buffer_.data());
+						auto n=std::min(buffer_.size(),preface.size());
+						if (std::equal(preface.begin(),preface.begin()+n,begin)) {
+
+							if (n!=preface.size()) return true;
+							buffer_.consume(n);
+							if (!settings_) settings();
+							preface_=true;
+							break;
+
+						}
+						if (settings_) return false;
+
+						//	An HTTP/1.1 request which asks to be upgraded
+						//	to h2c, it becomes stream 1
+						static const std::string crlf("\r\n\r\n");
+						auto end=asio::buffers_end(buffer_.data());
+						auto iter=std::search(begin,end,crlf.begin(),crlf.end());
+						if (iter==end) return true;
+						buffer_.consume((iter-begin)+crlf.size());
+						static const std::string switching("HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n");
+						pending_+=switching;
+						settings();
+						respond(1);
+
+					}
+
+					while (buffer_.size()>=frame_header_size) {
+
+						unsigned char header [frame_header_size];
+						asio::buffer_copy(asio::buffer(header),buffer_.data());
+						std::size_t size=(std::size_t(header[0])<<16)|(std::size_t(header[1])<<8)|header[2];
+						if (buffer_.size()<(frame_header_size+size)) break;
+						auto type=header[3];
+						auto flags=header[4];
+						std::uint32_t stream=((std::uint32_t(header[5])&0x7F)<<24)|(std::uint32_t(header[6])<<16)|(std::uint32_t(header[7])<<8)|header[8];
+						buffer_.consume(frame_header_size);
+						std::string payload(asio::buffers_begin(buffer_.data()),asio::buffers_begin(buffer_.data())+size);
+						buffer_.consume(size);
+
+						switch (type) {
+
+							case settings_frame:
+								if (!(flags&ack)) frame(settings_frame,ack,0,nullptr,0);
+								break;
+							case ping_frame:
+								if (!(flags&ack)) frame(ping_frame,ack,0,payload.data(),payload.size());
+								break;
+							//	Request bodies are discarded, the response is sent
+							//	once the request is complete
+							case headers_frame:
+							case data_frame:
+								if (flags&end_stream) respond(stream);
+								break;
+							case goaway_frame:
+								return false;
+							default:
+								break;
+
+						}
+
+					}
+
+					return true;
+
+				}
+
+
+			public:
+
+
+				connection (asio::io_service & ios, std::size_t body) : socket_(ios), settings_(false), preface_(false), body_(body) {	}
+
+
+				asio::ip::tcp::socket & socket () noexcept {
+
+					return socket_;
+
+				}
+
+
+				void start () {
+
+					read();
+
+				}
+
+
+				void read () {
+
+					socket_.async_read_some(buffer_.prepare(max_frame_size),[self=shared_from_this()] (const auto & ec, auto n) {
+
+						if (ec) return;
+						self->buffer_.commit(n);
+						if (!self->process()) {
+
+							asiocurl::error_code ignored;
+							self->socket_.shutdown(asio::ip::tcp::socket::shutdown_both,ignored);
+							return;
+
+						}
+						self->flush();
+						self->read();
+
+					});
+
+				}
+
+
+		};
+
+
+	}
+
+
+	void h2_server::accept () {
+
+		auto c=std::make_shared<connection>(ios_,body_);
+		acceptor_.async_accept(c->socket(),[this,c] (const auto & ec) {
+
+			if (ec) return;
+			++connections_;
+			c->socket().set_option(asio::ip::tcp::no_delay(true));
+			c->start();
+			accept();
+
+		});
+
+	}
+
+
+	h2_server::h2_server (std::size_t body)
+		:	work_(asiocurl::in_place,ios_),
+			acceptor_(ios_,asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(),0)),
+			body_(body),
+			connections_(0)
+	{
+
+		accept();
+		thread_=std::thread([this] () noexcept {	ios_.run();	});
+
+	}
+
+
+	h2_server::~h2_server () noexcept {
+
+		work_=asiocurl::nullopt;
+		ios_.stop();
+		thread_.join();
+
+	}
+
+
+	unsigned short h2_server::port () const {
+
+		return acceptor_.local_endpoint().port();
+
+	}
+
+
+	std::string h2_server::url (const std::string & path) const {
+
+		std::ostringstream ss;
+		ss << "http://127.0.0.1:" << port() << path;
+
+		return ss.str();
+
+	}
+
+
+	std::size_t h2_server::connections () const noexcept {
+
+		return connections_;
+
+	}
+
+
+	double h2_server::cpu_seconds () {
+
+		return bench::cpu_seconds(thread_);
+
+	}
+
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/optional.hpp>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+
+namespace bench {
+
+
+	/**
+	 *	A minimal in-process cleartext HTTP/2 server listening on
+	 *	the loopback interface.
+	 *
+	 *	Clients may either upgrade from HTTP/1.1 (i.e.
+	 *	CURL_HTTP_VERSION_2_0) or use prior knowledge (i.e.
+	 *	CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE).  Every request,
+	 *	whatever its path, is answered with a body of a fixed
+	 *	size.
+	 *
+	 *	Flow control is not implemented (the client's windows are
+	 *	assumed never to be exhausted) and so bodies should be small.
+	 */
+	class h2_server {
+
+
+		private:
+
+
+			asiocurl::asio::io_service ios_;
+			asiocurl::optional<asiocurl::asio::io_service::work> work_;
+			asiocurl::asio::ip::tcp::acceptor acceptor_;
+			std::size_t body_;
+			std::atomic<std::size_t> connections_;
+			std::thread thread_;
+
+
+			void accept ();
+
+
+		public:
+
+
+			h2_server (const h2_server &) = delete;
+			h2_server (h2_server &&) = delete;
+			h2_server & operator = (const h2_server &) = delete;
+			h2_server & operator = (h2_server &&) = delete;
+
+
+			/**
+			 *	Starts the server.
+			 *
+			 *	\param [in] body
+			 *		The size of the body of each response.
+			 */
+			explicit h2_server (std::size_t body=2);
+			~h2_server () noexcept;
+
+
+			unsigned short port () const;
+			std::string url (const std::string & path="/") const;
+			/**
+			 *	The CPU time consumed by the threads of this server
+			 *	in seconds.
+			 */
+			double cpu_seconds ();
+			/**
+			 *	The number of connections which have been accepted.
+			 */
+			std::size_t connections () const noexcept;
+
+
+	};
+
+
+}
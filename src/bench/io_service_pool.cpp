@@ -0,0 +1,53 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/easy.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service_pool.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+//	Measures transfers per second through an asiocurl::io_service_pool
+//	as the number of shards grows from one to --shards (by default the
+//	number of hardware threads)
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	std::size_t hardware=std::thread::hardware_concurrency();
+	auto max_shards=args.get("shards",(hardware==0) ? 1 : hardware);
+	auto transfers=args.get("transfers",20000);
+	auto concurrency=args.get("concurrency",256);
+
+	asiocurl::init init;
+	bench::server server(max_shards);
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(server.url()));
+
+	using policy=asiocurl::io_service_pool::policy;
+	for (auto p : {policy::round_robin,policy::least_in_flight}) for (std::size_t shards=1;shards<=max_shards;++shards) {
+
+		asiocurl::io_service_pool pool(shards,p);
+		//	Warm up connection caches
+		bench::run(pool,handles,handles.size()*shards);
+		auto seconds=bench::run(pool,handles,transfers);
+
+		bench::report("io_service_pool")
+			("policy",(p==policy::round_robin) ? "round_robin" : "least_in_flight")
+			("shards",shards)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("seconds",seconds)
+			("transfers_per_second",transfers/seconds);
+
+	}
+
+	return 0;
+
+}
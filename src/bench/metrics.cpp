@@ -0,0 +1,72 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/metrics.hpp>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+//	Performs --transfers (by default 100000) keep-alive loopback
+//	transfers of --body (by default 512) bytes with --concurrency (by
+//	default 64) in flight at once, first with instrumentation disabled
+//	(off) and then enabled (on), so that the cost of recording each
+//	transfer's statistics may be seen, and then reports the latency
+//	histograms gathered and the cost of taking a snapshot thereof
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto transfers=args.get("transfers",100000);
+	auto concurrency=args.get("concurrency",64);
+	auto body=args.get("body",512);
+	auto snapshots=args.get("snapshots",1000);
+
+	asiocurl::init init;
+	bench::server server;
+	auto url=server.url("/bytes/"+std::to_string(body));
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(url));
+
+	for (bool instrument : {false,true}) {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service::options o;
+		o.instrument=instrument;
+		asiocurl::io_service curl(ios,o);
+		bench::threads t(ios,1);
+		//	Establish connections
+		bench::run(curl,handles,handles.size());
+		auto seconds=bench::run(curl,handles,transfers);
+
+		bench::stopwatch sw;
+		asiocurl::metrics m;
+		for (std::size_t i=0;i<snapshots;++i) m=curl.metrics();
+		auto snapshot_seconds=sw.seconds();
+
+		auto us=[] (std::chrono::microseconds d) {	return static_cast<double>(d.count());	};
+		bench::report("metrics")
+			("instrument",instrument ? "on" : "off")
+			("transfers",transfers)
+			("seconds",seconds)
+			("transfers_per_second",transfers/seconds)
+			("completed",m.completed)
+			("bytes_in",m.bytes_in)
+			("total_p50_us",us(m.total.percentile(0.5)))
+			("total_p99_us",us(m.total.percentile(0.99)))
+			("total_p999_us",us(m.total.percentile(0.999)))
+			("ttfb_p99_us",us(m.start_transfer.percentile(0.99)))
+			("snapshot_us",(snapshot_seconds*1e6)/static_cast<double>(snapshots));
+
+	}
+
+	return 0;
+
+}
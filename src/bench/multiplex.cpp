@@ -0,0 +1,106 @@
+#include "bench.hpp"
+#include "h2_server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//	Performs --transfers (by default 100000) HTTP/2 loopback transfers
+//	of --body (by default 512) bytes with --concurrency (by default 256)
+//	in flight at once while limiting the asiocurl::io_service to
+//	--connections (by default 4) connections
+//
+//	-	serial: Multiplexing is disabled so each connection carries
+//		one transfer at a time and the remainder wait for a connection
+//	-	multiplex: Transfers are multiplexed over the connections
+
+
+namespace {
+
+
+	double run (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::size_t transfers) {
+
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		futures.reserve(handles.size());
+
+		bench::stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=handles.size()) {
+
+			futures.clear();
+			for (auto && easy : handles) futures.push_back(curl.add(easy));
+			for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+
+		}
+
+		return sw.seconds();
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto concurrency=args.get("concurrency",256);
+	auto transfers=args.get("transfers",100000);
+	auto connections=args.get("connections",4);
+	auto body=args.get("body",512);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::h2_server server(body);
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) {
+
+		handles.push_back(bench::make_easy(server.url()));
+		//	Some versions of libcurl fail to reuse connections
+		//	established with prior knowledge so each connection
+		//	is upgraded from HTTP/1.1
+		bench::set(handles.back(),CURLOPT_HTTP_VERSION,static_cast<long>(CURL_HTTP_VERSION_2_0));
+		//	Wait for an existing connection to be usable for
+		//	multiplexing rather than opening another
+		bench::set(handles.back(),CURLOPT_PIPEWAIT,1L);
+
+	}
+
+	for (const char * mode : {"serial","multiplex"}) {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service::options o;
+		o.multiplex=mode==std::string("multiplex");
+		o.max_host_connections=static_cast<long>(connections);
+		asiocurl::io_service curl(ios,o);
+		bench::threads t(ios,1);
+
+		auto before=server.connections();
+		//	Warm up connection cache
+		run(curl,handles,handles.size());
+		auto seconds=run(curl,handles,transfers);
+
+		bench::report("multiplex")
+			("mode",mode)
+			("concurrency",concurrency)
+			("connections",connections)
+			("transfers",transfers)
+			("body",body)
+			("connections_opened",server.connections()-before)
+			("seconds",seconds)
+			("requests_per_second",transfers/seconds);
+
+	}
+
+	return 0;
+
+}
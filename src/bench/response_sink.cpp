@@ -0,0 +1,140 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/response_sink.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//	Performs --transfers (by default 100000) keep-alive loopback
+//	transfers of --body (by default 512) bytes with --concurrency (by
+//	default 64) in flight at once, collecting each response body
+//	either by appending it to a std::string (string) or through an
+//	asiocurl::response_sink backed by the asiocurl::io_service's
+//	asiocurl::slab_pool (sink)
+
+
+namespace {
+
+
+	std::size_t append (char * ptr, std::size_t size, std::size_t nmemb, void * userdata) noexcept {
+
+		auto n=size*nmemb;
+		try {
+
+			static_cast<std::string *>(userdata)->append(ptr,n);
+
+		} catch (...) {
+
+			return 0;
+
+		}
+
+		return n;
+
+	}
+
+
+	template <typename Sink>
+	double run (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::size_t body, std::size_t transfers, Sink sink) {
+
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		futures.reserve(handles.size());
+
+		bench::stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=handles.size()) {
+
+			futures.clear();
+			std::vector<decltype(sink(curl,handles.front()))> sinks;
+			sinks.reserve(handles.size());
+			for (auto && easy : handles) {
+
+				sinks.push_back(sink(curl,easy));
+				futures.push_back(curl.add(easy));
+
+			}
+			for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+			for (auto && s : sinks) if (s->size()!=body) throw std::runtime_error("Incomplete body");
+
+		}
+
+		return sw.seconds();
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto concurrency=args.get("concurrency",64);
+	auto transfers=args.get("transfers",100000);
+	auto body=args.get("body",512);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server;
+	auto url=server.url("/bytes/"+std::to_string(body));
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(url));
+
+	for (const char * mode : {"string","sink"}) {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		bench::threads t(ios,1);
+
+		double seconds;
+		if (mode==std::string("string")) {
+
+			auto sink=[] (asiocurl::io_service &, CURL * easy) {
+
+				auto retr=std::make_unique<std::string>();
+				bench::set(easy,CURLOPT_WRITEFUNCTION,&append);
+				bench::set(easy,CURLOPT_WRITEDATA,static_cast<void *>(retr.get()));
+
+				return retr;
+
+			};
+			//	Warm up connection cache
+			run(curl,handles,body,handles.size(),sink);
+			seconds=run(curl,handles,body,transfers,sink);
+
+		} else {
+
+			auto sink=[] (asiocurl::io_service & curl, CURL * easy) {
+
+				return std::make_unique<asiocurl::response_sink>(curl,easy);
+
+			};
+			run(curl,handles,body,handles.size(),sink);
+			seconds=run(curl,handles,body,transfers,sink);
+
+		}
+
+		bench::report("response_sink")
+			("mode",mode)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("body",body)
+			("seconds",seconds)
+			("requests_per_second",transfers/seconds);
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,17 @@
+#	Runs each of the comma separated BENCHMARKS in DIRECTORY in turn
+#	and collects the JSON lines they write in OUTPUT
+string(REPLACE "," ";" BENCHMARKS "${BENCHMARKS}")
+file(WRITE ${OUTPUT} "")
+foreach(benchmark ${BENCHMARKS})
+	message(STATUS "Running ${benchmark}")
+	execute_process(
+		COMMAND ${DIRECTORY}/${benchmark}
+		RESULT_VARIABLE result
+		OUTPUT_VARIABLE output
+	)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${benchmark} failed: ${result}")
+	endif()
+	file(APPEND ${OUTPUT} "${output}")
+endforeach()
+message(STATUS "Results written to ${OUTPUT}")
@@ -0,0 +1,215 @@
+#include "allocations.hpp"
+#include "bench.hpp"
+#include "h2_server.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/easy.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/histogram.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/io_service_pool.hpp>
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//	For each combination of --concurrency (by default 1,16,256,4096)
+//	transfers in flight and --threads (by default 1,2,4) shards of an
+//	asiocurl::io_service_pool performs at least --transfers (by default
+//	20000, or twice the concurrency if that is greater) loopback
+//	transfers of --body (by default 512) bytes in a closed loop (each
+//	transfer is restarted as soon as it completes) and reports:
+//
+//	-	Requests per second
+//	-	p50, p99, and p999 latency
+//	-	CPU time per request, excluding that of the server
+//	-	Allocations per request (this includes the server's
+//		allocations, which are the same for every request)
+//
+//	--protocol may be http1 (the default) or h2c, in which case the
+//	transfers of each shard are multiplexed over HTTP/2 connections
+//	upgraded from HTTP/1.1
+//
+//	--batch-events=1 sets asiocurl::io_service::options::batch_events on
+//	each shard
+//
+//	Concurrency of up to 50000 is supported provided that the limit on
+//	open file descriptors permits it, for example
+//	--concurrency=1,10,100,1000,10000,50000
+
+
+namespace {
+
+
+	using clock=std::chrono::steady_clock;
+
+
+	//	Keeps a fixed number of transfers in flight, each easy handle
+	//	always being added to the same shard so that each shard's
+	//	histogram is only ever recorded into by that shard's thread
+	class driver {
+
+
+		private:
+
+
+			asiocurl::io_service_pool & pool_;
+			std::vector<asiocurl::easy> & handles_;
+			std::vector<asiocurl::histogram> histograms_;
+			std::size_t transfers_;
+			std::atomic<std::size_t> issued_;
+			std::atomic<std::size_t> failures_;
+			bench::latch latch_;
+
+
+			void issue (std::size_t i) {
+
+				auto shard=i%pool_.size();
+				pool_[shard].async_perform(handles_[i],[this,i,shard,start=clock::now()] (auto ec, auto msg) {
+
+					if (ec || (msg.data.result!=CURLE_OK)) ++failures_;
+					else histograms_[shard].record(std::chrono::duration_cast<std::chrono::microseconds>(clock::now()-start));
+					if (issued_++<transfers_) issue(i);
+					else latch_.count_down();
+
+				});
+
+			}
+
+
+		public:
+
+
+			driver (asiocurl::io_service_pool & pool, std::vector<asiocurl::easy> & handles, std::size_t transfers)
+				:	pool_(pool),
+					handles_(handles),
+					histograms_(pool.size()),
+					transfers_(transfers),
+					issued_(handles.size()),
+					failures_(0),
+					latch_(handles.size())
+			{	}
+
+
+			asiocurl::histogram run () {
+
+				for (std::size_t i=0;i<handles_.size();++i) issue(i);
+				latch_.wait();
+
+				asiocurl::histogram retr;
+				for (auto && h : histograms_) retr.merge(h);
+
+				return retr;
+
+			}
+
+
+			std::size_t failures () const noexcept {
+
+				return failures_;
+
+			}
+
+
+	};
+
+
+	double ms (std::chrono::microseconds d) {
+
+		return static_cast<double>(d.count())/1000.0;
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto concurrencies=args.list("concurrency","1,16,256,4096");
+	auto thread_counts=args.list("threads","1,2,4");
+	auto min_transfers=args.get("transfers",20000);
+	auto body=args.get("body",512);
+	auto protocol=args.get("protocol","http1");
+	auto server_threads=args.get("server-threads",4);
+	bool batch_events=args.get("batch-events",0)!=0;
+	bool h2=protocol=="h2c";
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	std::unique_ptr<bench::server> server;
+	std::unique_ptr<bench::h2_server> h2_server;
+	std::string url;
+	if (h2) {
+
+		h2_server.reset(new bench::h2_server(body));
+		url=h2_server->url();
+
+	} else {
+
+		server.reset(new bench::server(server_threads));
+		url=server->url("/bytes/"+std::to_string(body));
+
+	}
+	auto server_cpu_seconds=[&] () {	return h2 ? h2_server->cpu_seconds() : server->cpu_seconds();	};
+
+	for (auto threads : thread_counts) for (auto concurrency : concurrencies) {
+
+		std::vector<asiocurl::easy> handles;
+		handles.reserve(concurrency);
+		for (std::size_t i=0;i<concurrency;++i) {
+
+			handles.push_back(bench::make_easy(url));
+			if (h2) bench::set(handles.back(),CURLOPT_HTTP_VERSION,static_cast<long>(CURL_HTTP_VERSION_2_0));
+
+		}
+
+		asiocurl::io_service_pool pool(threads);
+		asiocurl::io_service::options o;
+		if (h2) o.multiplex=true;
+		o.batch_events=batch_events;
+		for (std::size_t i=0;i<pool.size();++i) pool[i].set_options(o);
+
+		//	Establish connections
+		driver(pool,handles,0).run();
+
+		auto transfers=std::max(min_transfers,concurrency*2);
+		driver d(pool,handles,transfers);
+		auto cpu=bench::cpu_seconds();
+		auto server_cpu=server_cpu_seconds();
+		auto allocated=allocations();
+		bench::stopwatch sw;
+		auto latency=d.run();
+		auto seconds=sw.seconds();
+		auto client_cpu=(bench::cpu_seconds()-cpu)-(server_cpu_seconds()-server_cpu);
+		auto allocated_per_request=static_cast<double>(allocations()-allocated)/static_cast<double>(transfers);
+
+		bench::report("scaling")
+			("protocol",protocol)
+			("batch_events",batch_events)
+			("threads",threads)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("failures",d.failures())
+			("seconds",seconds)
+			("requests_per_second",transfers/seconds)
+			("p50_ms",ms(latency.percentile(0.5)))
+			("p99_ms",ms(latency.percentile(0.99)))
+			("p999_ms",ms(latency.percentile(0.999)))
+			("max_ms",ms(latency.max()))
+			("cpu_us_per_request",(client_cpu*1e6)/static_cast<double>(transfers))
+			("allocations_per_request",allocated_per_request);
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,57 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+//	Compares asiocurl::io_service::serialization::mutex with
+//	asiocurl::io_service::serialization::strand as the number
+//	of threads running a single asio::io_service grows from one
+//	to --threads (by default twice the number of hardware threads)
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	std::size_t hardware=std::thread::hardware_concurrency();
+	auto max_threads=args.get("threads",(hardware==0) ? 2 : (hardware*2));
+	auto transfers=args.get("transfers",20000);
+	auto concurrency=args.get("concurrency",256);
+
+	asiocurl::init init;
+	bench::server server;
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(server.url()));
+
+	using serialization=asiocurl::io_service::serialization;
+	for (auto s : {serialization::mutex,serialization::strand}) for (std::size_t threads=1;threads<=max_threads;threads*=2) {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios,s);
+		bench::threads t(ios,threads);
+		//	Warm up connection cache
+		bench::run(curl,handles,handles.size());
+		auto seconds=bench::run(curl,handles,transfers);
+
+		bench::report("serialization")
+			("mode",(s==serialization::mutex) ? "mutex" : "strand")
+			("threads",threads)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("seconds",seconds)
+			("transfers_per_second",transfers/seconds);
+
+	}
+
+	return 0;
+
+}
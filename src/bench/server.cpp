@@ -0,0 +1,264 @@
+#include "server.hpp"
+
+
+#include "bench.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/optional.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <strings.h>
+#include <thread>
+#include <utility>
+
+
+namespace bench {
+
+
+	namespace asio=asiocurl::asio;
+
+
+	namespace {
+
+
+		const std::string & filler () {
+
+			static const std::string retr(64*1024,'x');
+
+			return retr;
+
+		}
+
+
+		class connection : public std::enable_shared_from_this<connection> {
+
+
+			private:
+
+
+				//	Connections accepted over TCP and Unix domain
+				//	sockets alike
+				asio::generic::stream_protocol::socket socket_;
+				asio::streambuf buffer_;
+				std::string header_;
+				std::size_t remaining_;
+				bool close_;
+
+
+				void respond (const std::string & target) {
+
+					std::size_t length=2;
+					static const std::string prefix("/bytes/");
+					if (target.compare(0,prefix.size(),prefix)==0) length=std::strtoull(target.c_str()+prefix.size(),nullptr,10);
+
+					std::ostringstream ss;
+					ss << "HTTP/1.1 200 OK\r\nContent-Length: " << length << "\r\n";
+					if (close_) ss << "Connection: close\r\n";
+					ss << "\r\n";
+					header_=ss.str();
+					remaining_=length;
+
+					asio::async_write(socket_,asio::buffer(header_),[self=shared_from_this()] (const auto & ec, auto) {
+
+						if (!ec) self->body();
+
+					});
+
+				}
+
+
+				void body () {
+
+					if (remaining_==0) {
+
+						if (close_) {
+
+							try {
+
+								socket_.shutdown(asio::socket_base::shutdown_both);
+
+							} catch (...) {	}
+							return;
+
+						}
+
+						read();
+						return;
+
+					}
+
+					auto n=std::min(remaining_,filler().size());
+					remaining_-=n;
+					asio::async_write(socket_,asio::buffer(filler().data(),n),[self=shared_from_this()] (const auto & ec, auto) {
+
+						if (!ec) self->body();
+
+					});
+
+				}
+
+
+			public:
+
+
+				explicit connection (asio::io_service & ios) : socket_(ios), remaining_(0), close_(false) {	}
+
+
+				asio::generic::stream_protocol::socket & socket () noexcept {
+
+					return socket_;
+
+				}
+
+
+				void read () {
+
+					asio::async_read_until(socket_,buffer_,"\r\n\r\n",[self=shared_from_this()] (const auto & ec, auto n) {
+
+						if (ec) return;
+
+						std::string head(asio::buffers_begin(self->buffer_.data()),asio::buffers_begin(self->buffer_.data())+n);
+						self->buffer_.consume(n);
+
+						std::istringstream ss(head);
+						std::string method;
+						std::string target;
+						ss >> method >> target;
+						std::size_t content_length=0;
+						self->close_=false;
+						std::string line;
+						std::getline(ss,line);
+						while (std::getline(ss,line)) {
+
+							auto colon=line.find(':');
+							if (colon==std::string::npos) continue;
+							auto name=line.substr(0,colon);
+							auto value=line.substr(colon+1);
+							if (::strcasecmp(name.c_str(),"Content-Length")==0) content_length=std::strtoull(value.c_str(),nullptr,10);
+							else if (::strcasecmp(name.c_str(),"Connection")==0) self->close_=value.find("close")!=std::string::npos;
+
+						}
+
+						//	Discard the request body, if any
+						auto buffered=std::min(content_length,self->buffer_.size());
+						self->buffer_.consume(buffered);
+						content_length-=buffered;
+						if (content_length==0) {
+
+							self->respond(target);
+							return;
+
+						}
+
+						asio::async_read(self->socket_,self->buffer_,asio::transfer_exactly(content_length),[self,target,content_length] (const auto & ec, auto) {
+
+							if (ec) return;
+							self->buffer_.consume(content_length);
+							self->respond(target);
+
+						});
+
+					});
+
+				}
+
+
+		};
+
+
+	}
+
+
+	template <typename Acceptor>
+	void server::accept (Acceptor & acceptor) {
+
+		auto c=std::make_shared<connection>(ios_);
+		acceptor.async_accept(c->socket(),[this,&acceptor,c] (const auto & ec) {
+
+			if (ec) return;
+			//	Fails harmlessly for Unix domain sockets
+			asiocurl::error_code ignored;
+			c->socket().set_option(asio::ip::tcp::no_delay(true),ignored);
+			c->read();
+			accept(acceptor);
+
+		});
+
+	}
+
+
+	server::server (std::size_t threads)
+		:	work_(asiocurl::in_place,ios_),
+			acceptor_(ios_,asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(),0)),
+			local_acceptor_(ios_)
+	{
+
+		accept(acceptor_);
+		for (std::size_t i=0;i<threads;++i) threads_.emplace_back([this] () noexcept {	ios_.run();	});
+
+	}
+
+
+	server::~server () noexcept {
+
+		work_=asiocurl::nullopt;
+		ios_.stop();
+		for (auto && t : threads_) t.join();
+		if (!path_.empty()) std::remove(path_.c_str());
+
+	}
+
+
+	void server::listen (const std::string & path) {
+
+		std::remove(path.c_str());
+		local_acceptor_.open();
+		local_acceptor_.bind(asio::local::stream_protocol::endpoint(path));
+		local_acceptor_.listen();
+		path_=path;
+		accept(local_acceptor_);
+
+	}
+
+
+	const std::string & server::path () const noexcept {
+
+		return path_;
+
+	}
+
+
+	unsigned short server::port () const {
+
+		return acceptor_.local_endpoint().port();
+
+	}
+
+
+	std::string server::url (const std::string & path) const {
+
+		std::ostringstream ss;
+		ss << "http://127.0.0.1:" << port() << path;
+
+		return ss.str();
+
+	}
+
+
+	double server::cpu_seconds () {
+
+		double retr=0;
+		for (auto && t : threads_) retr+=bench::cpu_seconds(t);
+
+		return retr;
+
+	}
+
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/optional.hpp>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace bench {
+
+
+	/**
+	 *	A minimal in-process HTTP/1.1 server listening on the
+	 *	loopback interface and optionally on a Unix domain
+	 *	socket.
+	 *
+	 *	The following paths are understood:
+	 *
+	 *	-	/bytes/N responds with a body of N bytes
+	 *	-	Anything else responds with a two byte body
+	 *
+	 *	Connections are kept alive unless the client sends
+	 *	"Connection: close".
+	 */
+	class server {
+
+
+		private:
+
+
+			asiocurl::asio::io_service ios_;
+			asiocurl::optional<asiocurl::asio::io_service::work> work_;
+			asiocurl::asio::ip::tcp::acceptor acceptor_;
+			asiocurl::asio::local::stream_protocol::acceptor local_acceptor_;
+			std::string path_;
+			std::vector<std::thread> threads_;
+
+
+			template <typename Acceptor>
+			void accept (Acceptor &);
+
+
+		public:
+
+
+			server (const server &) = delete;
+			server (server &&) = delete;
+			server & operator = (const server &) = delete;
+			server & operator = (server &&) = delete;
+
+
+			/**
+			 *	Starts the server.
+			 *
+			 *	\param [in] threads
+			 *		The number of threads which shall service
+			 *		connections.
+			 */
+			explicit server (std::size_t threads=1);
+			~server () noexcept;
+
+
+			unsigned short port () const;
+			std::string url (const std::string & path="/") const;
+			/**
+			 *	Also accepts connections on a Unix domain socket.
+			 *
+			 *	\param [in] path
+			 *		The path at which the socket is created.  Any
+			 *		file already there is replaced, and the socket
+			 *		is removed when the server is destroyed.
+			 */
+			void listen (const std::string & path);
+			/**
+			 *	The path passed to \ref listen, which is to be
+			 *	passed as CURLOPT_UNIX_SOCKET_PATH along with a URL
+			 *	obtained from \ref url.
+			 */
+			const std::string & path () const noexcept;
+			/**
+			 *	The CPU time consumed by the threads of this server
+			 *	in seconds.
+			 */
+			double cpu_seconds ();
+
+
+	};
+
+
+}
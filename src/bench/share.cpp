@@ -0,0 +1,314 @@
+#include "bench.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service_pool.hpp>
+#include <asiocurl/optional.hpp>
+#include <asiocurl/share.hpp>
+#include <curl/curl.h>
+#include <openssl/evp.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef ASIOCURL_USE_BOOST_ASIO
+#include <boost/asio/ssl.hpp>
+#else
+#include <asio/ssl.hpp>
+#endif
+
+
+//	Performs --transfers (by default 5000) HTTPS transfers against
+//	an in-process TLS server with --concurrency (by default 64) in
+//	flight at once spread round robin across --instances (by default
+//	4) asiocurl::io_service objects
+//
+//	Each transfer uses a new easy handle and a new connection, as
+//	an application which creates an easy handle per request does,
+//	so without an asiocurl::share (isolated) every transfer performs
+//	a full TLS handshake whereas with one (shared) TLS sessions are
+//	resumed across easy handles and instances, the server counts
+//	full and resumed handshakes
+
+
+namespace {
+
+
+	namespace asio=asiocurl::asio;
+
+
+	//	Creates a self-signed certificate for 127.0.0.1 so that
+	//	no files are required
+	void self_sign (asio::ssl::context & ctx) {
+
+		EVP_PKEY * key=nullptr;
+		std::unique_ptr<EVP_PKEY_CTX,decltype(&EVP_PKEY_CTX_free)> kctx(EVP_PKEY_CTX_new_id(EVP_PKEY_EC,nullptr),&EVP_PKEY_CTX_free);
+		if (
+			!kctx ||
+			(EVP_PKEY_keygen_init(kctx.get())<=0) ||
+			(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(kctx.get(),NID_X9_62_prime256v1)<=0) ||
+			(EVP_PKEY_keygen(kctx.get(),&key)<=0)
+		) throw std::runtime_error("Key generation failed");
+		std::unique_ptr<EVP_PKEY,decltype(&EVP_PKEY_free)> k(key,&EVP_PKEY_free);
+
+		std::unique_ptr<X509,decltype(&X509_free)> x(X509_new(),&X509_free);
+		if (!x) throw std::runtime_error("X509_new failed");
+		ASN1_INTEGER_set(X509_get_serialNumber(x.get()),1);
+		X509_gmtime_adj(X509_getm_notBefore(x.get()),0);
+		X509_gmtime_adj(X509_getm_notAfter(x.get()),24*60*60);
+		X509_set_pubkey(x.get(),key);
+		auto name=X509_get_subject_name(x.get());
+		X509_NAME_add_entry_by_txt(name,"CN",MBSTRING_ASC,reinterpret_cast<const unsigned char *>("127.0.0.1"),-1,-1,0);
+		X509_set_issuer_name(x.get(),name);
+		if (X509_sign(x.get(),key,EVP_sha256())==0) throw std::runtime_error("X509_sign failed");
+
+		if (
+			(SSL_CTX_use_certificate(ctx.native_handle(),x.get())!=1) ||
+			(SSL_CTX_use_PrivateKey(ctx.native_handle(),key)!=1)
+		) throw std::runtime_error("Installing certificate failed");
+
+	}
+
+
+	//	Answers one request per connection over TLS and counts
+	//	how many handshakes resumed a session
+	class tls_server {
+
+
+		private:
+
+
+			using stream_type=asio::ssl::stream<asio::ip::tcp::socket>;
+
+
+			class connection : public std::enable_shared_from_this<connection> {
+
+
+				public:
+
+
+					tls_server & server;
+					stream_type stream;
+					asio::streambuf buffer;
+
+
+					connection (tls_server & s) : server(s), stream(s.ios_,s.ctx_) {	}
+
+
+					void start () {
+
+						auto self=shared_from_this();
+						stream.async_handshake(asio::ssl::stream_base::server,[self] (const auto & ec) {
+
+							if (ec) return;
+							if (SSL_session_reused(self->stream.native_handle())) ++self->server.resumed_;
+							else ++self->server.full_;
+							asio::async_read_until(self->stream,self->buffer,"\r\n\r\n",[self] (const auto & ec, auto) {
+
+								if (ec) return;
+								static const std::string response("HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nOK");
+								asio::async_write(self->stream,asio::buffer(response),[self] (const auto &, auto) {
+
+									asiocurl::error_code ignored;
+									self->stream.lowest_layer().shutdown(asio::ip::tcp::socket::shutdown_both,ignored);
+
+								});
+
+							});
+
+						});
+
+					}
+
+
+			};
+
+
+			asio::io_service ios_;
+			asiocurl::optional<asio::io_service::work> work_;
+			asio::ssl::context ctx_;
+			asio::ip::tcp::acceptor acceptor_;
+			std::vector<std::thread> threads_;
+			std::atomic<std::size_t> full_;
+			std::atomic<std::size_t> resumed_;
+
+
+			void accept () {
+
+				auto c=std::make_shared<connection>(*this);
+				acceptor_.async_accept(c->stream.lowest_layer(),[this,c] (const auto & ec) {
+
+					if (ec) return;
+					c->start();
+					accept();
+
+				});
+
+			}
+
+
+		public:
+
+
+			tls_server (const tls_server &) = delete;
+			tls_server (tls_server &&) = delete;
+			tls_server & operator = (const tls_server &) = delete;
+			tls_server & operator = (tls_server &&) = delete;
+
+
+			explicit tls_server (std::size_t threads)
+				:	work_(asiocurl::in_place,ios_),
+					ctx_(asio::ssl::context::tls_server),
+					acceptor_(ios_,asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(),0)),
+					full_(0),
+					resumed_(0)
+			{
+
+				self_sign(ctx_);
+				accept();
+				for (std::size_t i=0;i<threads;++i) threads_.emplace_back([this] () noexcept {	ios_.run();	});
+
+			}
+
+
+			~tls_server () noexcept {
+
+				work_=asiocurl::nullopt;
+				ios_.stop();
+				for (auto && t : threads_) t.join();
+
+			}
+
+
+			std::string url () const {
+
+				std::ostringstream ss;
+				ss << "https://127.0.0.1:" << acceptor_.local_endpoint().port() << "/";
+
+				return ss.str();
+
+			}
+
+
+			std::size_t full () const noexcept {
+
+				return full_;
+
+			}
+
+
+			std::size_t resumed () const noexcept {
+
+				return resumed_;
+
+			}
+
+
+			void reset () noexcept {
+
+				full_=0;
+				resumed_=0;
+
+			}
+
+
+	};
+
+
+	asiocurl::easy make_easy (const std::string & url) {
+
+		auto retr=bench::make_easy(url);
+		bench::set(retr,CURLOPT_SSL_VERIFYPEER,0L);
+		bench::set(retr,CURLOPT_SSL_VERIFYHOST,0L);
+		bench::set(retr,CURLOPT_FORBID_REUSE,1L);
+
+		return retr;
+
+	}
+
+
+	double run (asiocurl::io_service_pool & pool, const std::string & url, std::size_t concurrency, std::size_t transfers) {
+
+		std::vector<asiocurl::easy> handles;
+		handles.reserve(concurrency);
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		futures.reserve(concurrency);
+
+		bench::stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=concurrency) {
+
+			handles.clear();
+			futures.clear();
+			for (std::size_t i=0;i<concurrency;++i) {
+
+				handles.push_back(make_easy(url));
+				futures.push_back(pool.add(handles.back()));
+
+			}
+			for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+
+		}
+
+		return sw.seconds();
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto instances=args.get("instances",4);
+	auto concurrency=args.get("concurrency",64);
+	auto transfers=args.get("transfers",5000);
+	auto server_threads=args.get("server-threads",2);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	tls_server server(server_threads);
+	auto url=server.url();
+
+	std::size_t isolated=0;
+	for (const char * mode : {"isolated","shared"}) {
+
+		asiocurl::share sh;
+		auto shared=mode==std::string("shared");
+		asiocurl::optional<asiocurl::io_service_pool> pool;
+		if (shared) pool.emplace(instances,sh);
+		else pool.emplace(instances);
+
+		server.reset();
+		auto seconds=run(*pool,url,concurrency,transfers);
+		pool=asiocurl::nullopt;
+		auto full=server.full();
+		if (!shared) isolated=full;
+
+		bench::report("share")
+			("mode",mode)
+			("instances",instances)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("seconds",seconds)
+			("requests_per_second",transfers/seconds)
+			("full_handshakes",full)
+			("resumed_handshakes",server.resumed())
+			("handshakes_avoided",(shared && (full<isolated)) ? (isolated-full) : 0);
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,62 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/metrics.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+//	Performs --transfers (by default 64) loopback downloads of --body
+//	(by default 16 MiB) bytes with --concurrency (by default 4) in
+//	flight at once and reports throughput along with the number of
+//	times the io_service was woken by socket readiness and the number
+//	of calls to curl_multi_socket_action per MiB downloaded
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto transfers=args.get("transfers",64);
+	auto body=args.get("body",16*1024*1024);
+	auto concurrency=args.get("concurrency",4);
+
+	asiocurl::init init;
+	bench::server server(concurrency);
+	auto url=server.url("/bytes/"+std::to_string(body));
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(url));
+
+	asiocurl::asio::io_service ios;
+	asiocurl::io_service curl(ios);
+	bench::threads t(ios,1);
+	//	Establish connections
+	bench::run(curl,handles,handles.size());
+	auto before=curl.metrics();
+	auto cpu=bench::cpu_seconds();
+	auto server_cpu=server.cpu_seconds();
+	auto seconds=bench::run(curl,handles,transfers);
+	auto client_cpu=(bench::cpu_seconds()-cpu)-(server.cpu_seconds()-server_cpu);
+	auto after=curl.metrics();
+
+	//	bench::run may perform a few more transfers than requested
+	auto completed=after.completed-before.completed;
+	auto mib=static_cast<double>(completed*body)/(1024.0*1024.0);
+	bench::report("streaming")
+		("transfers",completed)
+		("body",body)
+		("concurrency",concurrency)
+		("seconds",seconds)
+		("mib_per_second",mib/seconds)
+		("wakeups_per_mib",static_cast<double>(after.wakeups-before.wakeups)/mib)
+		("actions_per_mib",static_cast<double>(after.actions-before.actions)/mib)
+		("cpu_ms_per_mib",(client_cpu*1e3)/mib);
+
+	return 0;
+
+}
@@ -0,0 +1,60 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/metrics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+//	Performs --transfers (by default 100000) keep-alive loopback
+//	transfers of --body (by default 512) bytes with --concurrency (by
+//	default 1000) in flight at once and reports how often libcurl
+//	changed its timeout and how often the io_service had to start its
+//	timer or post an action in response, per completed transfer
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto transfers=args.get("transfers",100000);
+	auto concurrency=args.get("concurrency",1000);
+	auto body=args.get("body",512);
+
+	bench::raise_descriptor_limit();
+	asiocurl::init init;
+	bench::server server(4);
+	auto url=server.url("/bytes/"+std::to_string(body));
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) handles.push_back(bench::make_easy(url));
+
+	asiocurl::asio::io_service ios;
+	asiocurl::io_service curl(ios);
+	bench::threads t(ios,1);
+	//	Establish connections
+	bench::run(curl,handles,handles.size());
+	auto before=curl.metrics();
+	auto seconds=bench::run(curl,handles,transfers);
+	auto after=curl.metrics();
+
+	auto completed=static_cast<double>(after.completed-before.completed);
+	auto per_transfer=[&] (std::uint64_t a, std::uint64_t b) {	return static_cast<double>(a-b)/completed;	};
+	bench::report("timer")
+		("transfers",after.completed-before.completed)
+		("concurrency",concurrency)
+		("seconds",seconds)
+		("transfers_per_second",completed/seconds)
+		("updates_per_transfer",per_transfer(after.timer_updates,before.timer_updates))
+		("waits_per_transfer",per_transfer(after.timer_waits,before.timer_waits))
+		("posts_per_transfer",per_transfer(after.timer_posts,before.timer_posts))
+		("timer_ops_per_transfer",per_transfer(after.timer_waits+after.timer_posts,before.timer_waits+before.timer_posts));
+
+	return 0;
+
+}
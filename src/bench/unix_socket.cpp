@@ -0,0 +1,161 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/histogram.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+//	Performs --transfers (by default 20000) transfers of --body (by
+//	default 512) bytes with --concurrency (by default 1) in flight at
+//	once in a closed loop, first over loopback TCP and then over a Unix
+//	domain socket (CURLOPT_UNIX_SOCKET_PATH) served by the same server,
+//	and reports for each requests per second, p50, p99, and p999
+//	latency, and CPU time per request excluding that of the server
+
+
+namespace {
+
+
+	using clock=std::chrono::steady_clock;
+
+
+	//	Keeps every handle busy until the requested number of transfers
+	//	have been issued, all completions run on the single thread which
+	//	runs the io_service so the histogram needs no synchronization
+	class driver {
+
+
+		private:
+
+
+			asiocurl::io_service & curl_;
+			std::vector<asiocurl::easy> & handles_;
+			asiocurl::histogram histogram_;
+			std::size_t transfers_;
+			std::size_t issued_;
+			std::size_t failures_;
+			bench::latch latch_;
+
+
+			void issue (std::size_t i) {
+
+				curl_.async_perform(handles_[i],[this,i,start=clock::now()] (auto ec, auto msg) {
+
+					if (ec || (msg.data.result!=CURLE_OK)) ++failures_;
+					else histogram_.record(std::chrono::duration_cast<std::chrono::microseconds>(clock::now()-start));
+					if (issued_++<transfers_) issue(i);
+					else latch_.count_down();
+
+				});
+
+			}
+
+
+		public:
+
+
+			driver (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, std::size_t transfers)
+				:	curl_(curl),
+					handles_(handles),
+					transfers_(transfers),
+					issued_(handles.size()),
+					failures_(0),
+					latch_(handles.size())
+			{	}
+
+
+			const asiocurl::histogram & run () {
+
+				for (std::size_t i=0;i<handles_.size();++i) issue(i);
+				latch_.wait();
+
+				return histogram_;
+
+			}
+
+
+			std::size_t failures () const noexcept {
+
+				return failures_;
+
+			}
+
+
+	};
+
+
+	double ms (std::chrono::microseconds d) {
+
+		return static_cast<double>(d.count())/1000.0;
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto transfers=args.get("transfers",20000);
+	auto body=args.get("body",512);
+	auto concurrency=args.get("concurrency",1);
+
+	asiocurl::init init;
+	bench::server server;
+	server.listen("/tmp/asiocurl-bench-"+std::to_string(::getpid())+".sock");
+	auto url=server.url("/bytes/"+std::to_string(body));
+
+	for (std::string transport : {"tcp","unix"}) {
+
+		std::vector<asiocurl::easy> handles;
+		for (std::size_t i=0;i<concurrency;++i) {
+
+			handles.push_back(bench::make_easy(url));
+			if (transport=="unix") bench::set(handles.back(),CURLOPT_UNIX_SOCKET_PATH,server.path().c_str());
+
+		}
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		bench::threads t(ios,1);
+		//	Establish connections
+		bench::run(curl,handles,handles.size());
+
+		driver d(curl,handles,transfers);
+		auto cpu=bench::cpu_seconds();
+		auto server_cpu=server.cpu_seconds();
+		bench::stopwatch sw;
+		auto && latency=d.run();
+		auto seconds=sw.seconds();
+		auto client_cpu=(bench::cpu_seconds()-cpu)-(server.cpu_seconds()-server_cpu);
+
+		bench::report("unix_socket")
+			("transport",transport)
+			("concurrency",concurrency)
+			("body",body)
+			("transfers",transfers)
+			("failures",d.failures())
+			("seconds",seconds)
+			("requests_per_second",transfers/seconds)
+			("p50_ms",ms(latency.percentile(0.5)))
+			("p99_ms",ms(latency.percentile(0.99)))
+			("p999_ms",ms(latency.percentile(0.999)))
+			("cpu_us_per_request",(client_cpu*1e6)/static_cast<double>(transfers));
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,220 @@
+#include "bench.hpp"
+#include "server.hpp"
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/init.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/upload.hpp>
+#include <curl/curl.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+//	POSTs --transfers (by default 2000) request bodies, each of which
+//	consists of --records (by default 1024) serialized records of
+//	--record-size (by default 1024) bytes, to the loopback server with
+//	--concurrency (by default 16) in flight at once
+//
+//	-	copy: Each request body is assembled into a std::string which
+//		is supplied by a CURLOPT_READFUNCTION
+//	-	upload: The records are supplied as a const buffer sequence
+//		through asiocurl::upload
+
+
+namespace {
+
+
+	class string_source {
+
+
+		private:
+
+
+			std::string body_;
+			std::size_t offset_;
+
+
+		public:
+
+
+			explicit string_source (const std::vector<std::string> & records) : offset_(0) {
+
+				for (auto && r : records) body_+=r;
+
+			}
+
+
+			static std::size_t read (char * ptr, std::size_t size, std::size_t nitems, void * userdata) noexcept {
+
+				auto & self=*static_cast<string_source *>(userdata);
+				auto n=std::min(size*nitems,self.body_.size()-self.offset_);
+				std::memcpy(ptr,self.body_.data()+self.offset_,n);
+				self.offset_+=n;
+
+				return n;
+
+			}
+
+
+			curl_off_t size () const noexcept {
+
+				return static_cast<curl_off_t>(body_.size());
+
+			}
+
+
+	};
+
+
+	class slist {
+
+
+		private:
+
+
+			curl_slist * list_;
+
+
+		public:
+
+
+			slist (const slist &) = delete;
+			slist (slist &&) = delete;
+			slist & operator = (const slist &) = delete;
+			slist & operator = (slist &&) = delete;
+
+
+			//	The loopback server does not answer Expect: 100-continue
+			slist () : list_(curl_slist_append(nullptr,"Expect:")) {
+
+				if (!list_) throw std::bad_alloc();
+
+			}
+
+
+			~slist () noexcept {
+
+				curl_slist_free_all(list_);
+
+			}
+
+
+			operator curl_slist * () const noexcept {
+
+				return list_;
+
+			}
+
+
+	};
+
+
+	template <typename Source>
+	double run (asiocurl::io_service & curl, std::vector<asiocurl::easy> & handles, const std::vector<std::string> & records, std::size_t transfers, Source source) {
+
+		std::vector<asiocurl::future<CURLMsg>> futures;
+		futures.reserve(handles.size());
+
+		bench::stopwatch sw;
+		for (std::size_t done=0;done<transfers;done+=handles.size()) {
+
+			futures.clear();
+			std::vector<decltype(source(curl,handles.front(),records))> sources;
+			sources.reserve(handles.size());
+			for (auto && easy : handles) {
+
+				sources.push_back(source(curl,easy,records));
+				futures.push_back(curl.add(easy));
+
+			}
+			for (auto && f : futures) if (f.get().data.result!=CURLE_OK) throw std::runtime_error("Transfer failed");
+
+		}
+
+		return sw.seconds();
+
+	}
+
+
+}
+
+
+int main (int argc, char ** argv) {
+
+	bench::arguments args(argc,argv);
+	auto transfers=args.get("transfers",2000);
+	auto concurrency=args.get("concurrency",16);
+	auto count=args.get("records",1024);
+	auto record_size=args.get("record-size",1024);
+
+	asiocurl::init init;
+	bench::server server;
+	slist headers;
+
+	std::vector<std::string> records(count,std::string(record_size,'r'));
+	std::vector<asiocurl::asio::const_buffer> buffers;
+	for (auto && r : records) buffers.push_back(asiocurl::asio::buffer(r));
+
+	std::vector<asiocurl::easy> handles;
+	for (std::size_t i=0;i<concurrency;++i) {
+
+		handles.push_back(bench::make_easy(server.url()));
+		bench::set(handles.back(),CURLOPT_POST,1L);
+		bench::set(handles.back(),CURLOPT_HTTPHEADER,static_cast<curl_slist *>(headers));
+
+	}
+
+	for (const char * mode : {"copy","upload"}) {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		bench::threads t(ios,1);
+
+		double seconds;
+		if (mode==std::string("copy")) {
+
+			seconds=run(curl,handles,records,transfers,[] (asiocurl::io_service &, CURL * easy, const std::vector<std::string> & records) {
+
+				auto retr=std::make_unique<string_source>(records);
+				bench::set(easy,CURLOPT_READFUNCTION,&string_source::read);
+				bench::set(easy,CURLOPT_READDATA,static_cast<void *>(retr.get()));
+				bench::set(easy,CURLOPT_POSTFIELDSIZE_LARGE,retr->size());
+
+				return retr;
+
+			});
+
+		} else {
+
+			seconds=run(curl,handles,records,transfers,[&] (asiocurl::io_service & curl, CURL * easy, const std::vector<std::string> &) {
+
+				return std::make_unique<asiocurl::upload>(curl,easy,buffers);
+
+			});
+
+		}
+
+		auto bytes=static_cast<double>(count*record_size)*transfers;
+		bench::report("upload")
+			("mode",mode)
+			("concurrency",concurrency)
+			("transfers",transfers)
+			("records",count)
+			("record_size",record_size)
+			("seconds",seconds)
+			("megabytes_per_second",bytes/(seconds*1024*1024));
+
+	}
+
+	return 0;
+
+}
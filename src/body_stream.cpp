@@ -0,0 +1,182 @@
+#include <asiocurl/asio.hpp>
+#include <asiocurl/body_stream.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+
+namespace asiocurl {
+
+
+	body_stream::operation::~operation () noexcept {	}
+
+
+	body_stream::state::state (io_service & c, CURL * e)
+		:	curl(c),
+			easy(e),
+			offset(0),
+			paused(false),
+			done(false)
+	{	}
+
+
+	std::size_t body_stream::state::write (char * ptr, std::size_t size, std::size_t nmemb, void * userdata) noexcept {
+
+		auto & self=*static_cast<state *>(userdata);
+		auto n=size*nmemb;
+		if (n==0) return 0;
+
+		operation_ptr op;
+		std::size_t copied;
+		{
+
+			std::lock_guard<std::mutex> l(self.m);
+			//	Nobody is reading: libcurl retains the data and
+			//	delivers it again once the transfer is resumed
+			if (!self.op) {
+
+				self.paused=true;
+				return CURL_WRITEFUNC_PAUSE;
+
+			}
+
+			copied=std::min(n,self.target.size());
+			std::memcpy(self.target.data(),ptr,copied);
+			try {
+
+				self.leftover.assign(ptr+copied,ptr+n);
+
+			//	Causes libcurl to fail the transfer with
+			//	CURLE_WRITE_ERROR
+			} catch (...) {
+
+				return 0;
+
+			}
+			self.offset=0;
+			op=std::move(self.op);
+
+		}
+
+		op->complete(error_code(),copied);
+
+		return n;
+
+	}
+
+
+	void body_stream::state::finish (error_code ec, const CURLMsg & msg) noexcept {
+
+		if (!ec && (msg.data.result!=CURLE_OK)) ec=make_error_code(msg.data.result);
+		if (!ec) ec=asio::error::eof;
+
+		operation_ptr op;
+		{
+
+			std::lock_guard<std::mutex> l(m);
+			done=true;
+			result=ec;
+			//	A read is only outstanding when there is no
+			//	leftover data
+			op=std::move(this->op);
+
+		}
+
+		if (op) op->complete(ec,0);
+
+	}
+
+
+	void body_stream::state::read (asio::mutable_buffer b, operation_ptr o) {
+
+		std::unique_lock<std::mutex> l(m);
+
+		if (op) {
+
+			l.unlock();
+			o->complete(asio::error::already_started,0);
+			return;
+
+		}
+
+		if (offset!=leftover.size()) {
+
+			auto n=std::min(leftover.size()-offset,b.size());
+			std::memcpy(b.data(),leftover.data()+offset,n);
+			offset+=n;
+			if (offset==leftover.size()) {
+
+				leftover.clear();
+				offset=0;
+
+			}
+			l.unlock();
+			o->complete(error_code(),n);
+			return;
+
+		}
+
+		if (done || (b.size()==0)) {
+
+			auto ec=done ? result : error_code();
+			l.unlock();
+			o->complete(ec,0);
+			return;
+
+		}
+
+		target=b;
+		op=std::move(o);
+		auto resume=paused;
+		paused=false;
+		//	curl_easy_pause delivers data which arrived while the
+		//	transfer was paused synchronously, and the write callback
+		//	acquires the lock
+		l.unlock();
+		if (resume) curl.unpause(easy);
+
+	}
+
+
+	template <typename T>
+	static void setopt (CURL * easy, CURLoption option, T param) {
+
+		auto result=curl_easy_setopt(easy,option,param);
+		if (result!=CURLE_OK) throw easy_error(result);
+
+	}
+
+
+	body_stream::body_stream (io_service & curl, CURL * easy) : state_(std::make_shared<state>(curl,easy)) {
+
+		setopt(easy,CURLOPT_WRITEFUNCTION,&state::write);
+		setopt(easy,CURLOPT_WRITEDATA,static_cast<void *>(state_.get()));
+		curl.async_perform(easy,[s=state_] (error_code ec, CURLMsg msg) {	s->finish(ec,msg);	});
+
+	}
+
+
+	body_stream::~body_stream () noexcept {
+
+		//	The completion handler of the transfer (and therefore
+		//	any outstanding read) runs with operation_aborted
+		state_->curl.remove(state_->easy);
+
+	}
+
+
+	body_stream::executor_type body_stream::get_executor () noexcept {
+
+		return state_->curl.get_io_service().get_executor();
+
+	}
+
+
+}
@@ -0,0 +1,154 @@
+#include <asiocurl/easy_pool.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+
+namespace asiocurl {
+
+
+	easy_pool::handle::handle (easy_pool & pool, easy e) noexcept : pool_(&pool), easy_(std::move(e)) {	}
+
+
+	void easy_pool::handle::destroy () noexcept {
+
+		if (!pool_) return;
+		pool_->release(std::move(easy_));
+		pool_=nullptr;
+
+	}
+
+
+	easy_pool::handle::handle (handle && rhs) noexcept : pool_(rhs.pool_), easy_(std::move(rhs.easy_)) {
+
+		rhs.pool_=nullptr;
+
+	}
+
+
+	easy_pool::handle & easy_pool::handle::operator = (handle && rhs) noexcept {
+
+		if (&rhs==this) return *this;
+
+		destroy();
+		pool_=rhs.pool_;
+		easy_=std::move(rhs.easy_);
+		rhs.pool_=nullptr;
+
+		return *this;
+
+	}
+
+
+	easy_pool::handle::~handle () noexcept {
+
+		destroy();
+
+	}
+
+
+	easy & easy_pool::handle::get () noexcept {
+
+		return easy_;
+
+	}
+
+
+	easy_pool::handle::operator easy::native_handle_type () const noexcept {
+
+		return easy_;
+
+	}
+
+
+	easy easy_pool::create () {
+
+		auto retr=[&] () {
+
+			if (!prototype_) return easy();
+			std::lock_guard<std::mutex> l(prototype_m_);
+			return easy(*prototype_);
+
+		}();
+		if (init_) init_(retr);
+
+		return retr;
+
+	}
+
+
+	void easy_pool::release (easy e) noexcept {
+
+		if (!e.native_handle()) return;
+
+		//	curl_easy_reset retains live connections and caches, which
+		//	is the reason handles are pooled at all
+		curl_easy_reset(e);
+		if (init_) try {
+
+			init_(e);
+
+		//	A handle which cannot be reinitialized is simply
+		//	discarded
+		} catch (...) {
+
+			return;
+
+		}
+
+		std::lock_guard<std::mutex> l(m_);
+		if (idle_.size()>=max_idle_) return;
+		try {
+
+			idle_.push_back(std::move(e));
+
+		} catch (...) {	}
+
+	}
+
+
+	easy_pool::easy_pool (std::size_t max_idle, initializer_type init) : max_idle_(max_idle), init_(std::move(init)) {	}
+
+
+	easy_pool::easy_pool (const easy & prototype, std::size_t max_idle, initializer_type init)
+		:	max_idle_(max_idle),
+			prototype_(in_place,prototype),
+			init_(std::move(init))
+	{	}
+
+
+	easy_pool::~easy_pool () noexcept {	}
+
+
+	easy_pool::handle easy_pool::acquire () {
+
+		{
+
+			std::unique_lock<std::mutex> l(m_);
+			if (!idle_.empty()) {
+
+				auto e=std::move(idle_.back());
+				idle_.pop_back();
+				l.unlock();
+
+				return handle(*this,std::move(e));
+
+			}
+
+		}
+
+		return handle(*this,create());
+
+	}
+
+
+	std::size_t easy_pool::idle () const noexcept {
+
+		std::lock_guard<std::mutex> l(m_);
+		return idle_.size();
+
+	}
+
+
+}
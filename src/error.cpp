@@ -0,0 +1,93 @@
+#include <asiocurl/error.hpp>
+#include <curl/curl.h>
+#include <string>
+
+
+namespace asiocurl {
+
+
+	namespace {
+
+
+		class easy_category_impl : public error_category {
+
+
+			public:
+
+
+				const char * name () const noexcept override {
+
+					return "libcurl easy";
+
+				}
+
+
+				std::string message (int ev) const override {
+
+					return curl_easy_strerror(static_cast<CURLcode>(ev));
+
+				}
+
+
+		};
+
+
+		class multi_category_impl : public error_category {
+
+
+			public:
+
+
+				const char * name () const noexcept override {
+
+					return "libcurl multi";
+
+				}
+
+
+				std::string message (int ev) const override {
+
+					return curl_multi_strerror(static_cast<CURLMcode>(ev));
+
+				}
+
+
+		};
+
+
+	}
+
+
+	const error_category & easy_category () noexcept {
+
+		static const easy_category_impl retr;
+
+		return retr;
+
+	}
+
+
+	const error_category & multi_category () noexcept {
+
+		static const multi_category_impl retr;
+
+		return retr;
+
+	}
+
+
+	error_code make_error_code (CURLcode code) noexcept {
+
+		return error_code(static_cast<int>(code),easy_category());
+
+	}
+
+
+	error_code make_error_code (CURLMcode code) noexcept {
+
+		return error_code(static_cast<int>(code),multi_category());
+
+	}
+
+
+}
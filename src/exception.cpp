@@ -31,4 +31,14 @@ namespace asiocurl {
 	}
 
 
+	share_error::share_error (CURLSHcode code) : error(curl_share_strerror(code)), code_(code) {	}
+
+
+	CURLSHcode share_error::code () const noexcept {
+
+		return code_;
+
+	}
+
+
 }
@@ -0,0 +1,177 @@
+#include <asiocurl/histogram.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace asiocurl {
+
+
+	//	Each power of two is divided into 2^sub_bits buckets
+	static constexpr unsigned sub_bits=4;
+	static constexpr std::uint64_t sub_buckets=std::uint64_t(1) << sub_bits;
+	static constexpr std::uint64_t limit=std::uint64_t(1) << 40;
+
+
+	static unsigned highest_bit (std::uint64_t v) noexcept {
+
+		unsigned retr=0;
+		for (unsigned shift=32;shift!=0;shift/=2) if ((v >> shift)!=0) {
+
+			v>>=shift;
+			retr+=shift;
+
+		}
+
+		return retr;
+
+	}
+
+
+	static std::uint64_t to_us (std::chrono::microseconds d) noexcept {
+
+		auto c=d.count();
+
+		return (c<0) ? 0 : static_cast<std::uint64_t>(c);
+
+	}
+
+
+	std::size_t histogram::bucket (std::uint64_t us) noexcept {
+
+		if (us<sub_buckets) return static_cast<std::size_t>(us);
+		if (us>=limit) us=limit-1;
+
+		auto e=highest_bit(us);
+		auto m=(us >> (e-sub_bits))&(sub_buckets-1);
+
+		return static_cast<std::size_t>(((e-sub_bits+1)*sub_buckets)+m);
+
+	}
+
+
+	std::uint64_t histogram::upper_bound (std::size_t i) noexcept {
+
+		if (i<sub_buckets) return i;
+
+		auto e=(i/sub_buckets)+sub_bits-1;
+		auto m=i%sub_buckets;
+		auto width=std::uint64_t(1) << (e-sub_bits);
+
+		return ((sub_buckets+m)*width)+width-1;
+
+	}
+
+
+	histogram::histogram () noexcept : count_(0), max_(0) {
+
+		counts_.fill(0);
+
+	}
+
+
+	void histogram::record (std::chrono::microseconds d) noexcept {
+
+		auto us=to_us(d);
+		++counts_[bucket(us)];
+		++count_;
+		max_=std::max(max_,us);
+
+	}
+
+
+	histogram & histogram::merge (const histogram & other) noexcept {
+
+		for (std::size_t i=0;i<buckets;++i) counts_[i]+=other.counts_[i];
+		count_+=other.count_;
+		max_=std::max(max_,other.max_);
+
+		return *this;
+
+	}
+
+
+	std::uint64_t histogram::count () const noexcept {
+
+		return count_;
+
+	}
+
+
+	std::uint64_t histogram::count (std::size_t i) const noexcept {
+
+		return counts_[i];
+
+	}
+
+
+	std::chrono::microseconds histogram::max () const noexcept {
+
+		return std::chrono::microseconds(max_);
+
+	}
+
+
+	std::chrono::microseconds histogram::percentile (double p) const noexcept {
+
+		if (count_==0) return std::chrono::microseconds(0);
+
+		p=std::min(std::max(p,0.0),1.0);
+		auto target=static_cast<std::uint64_t>(std::ceil(p*static_cast<double>(count_)));
+		if (target==0) target=1;
+
+		std::uint64_t seen=0;
+		for (std::size_t i=0;i<buckets;++i) {
+
+			seen+=counts_[i];
+			//	The upper bound of the bucket may exceed the
+			//	longest duration actually recorded
+			if (seen>=target) return std::chrono::microseconds(std::min(upper_bound(i),max_));
+
+		}
+
+		return max();
+
+	}
+
+
+	atomic_histogram::atomic_histogram () noexcept : max_(0) {
+
+		for (auto && c : counts_) c.store(0,std::memory_order_relaxed);
+
+	}
+
+
+	void atomic_histogram::record (std::chrono::microseconds d) noexcept {
+
+		//	There is only ever one writer so there is no need for
+		//	a locked read-modify-write
+		auto us=to_us(d);
+		auto & c=counts_[histogram::bucket(us)];
+		c.store(c.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+		if (us>max_.load(std::memory_order_relaxed)) max_.store(us,std::memory_order_relaxed);
+
+	}
+
+
+	histogram atomic_histogram::snapshot () const noexcept {
+
+		histogram retr;
+		for (std::size_t i=0;i<histogram::buckets;++i) {
+
+			auto n=counts_[i].load(std::memory_order_relaxed);
+			retr.counts_[i]=n;
+			retr.count_+=n;
+
+		}
+		retr.max_=max_.load(std::memory_order_relaxed);
+
+		return retr;
+
+	}
+
+
+}
@@ -1,16 +1,37 @@
 #include <asiocurl/asio.hpp>
 #include <asiocurl/configure.hpp>
+#include <asiocurl/error.hpp>
 #include <asiocurl/exception.hpp>
 #include <asiocurl/future.hpp>
+#include <asiocurl/histogram.hpp>
 #include <asiocurl/io_service.hpp>
+#include <asiocurl/metrics.hpp>
+#include <asiocurl/oneshot.hpp>
+#include <asiocurl/optional.hpp>
 #include <asiocurl/scope.hpp>
+#include <asiocurl/share.hpp>
+#include <asiocurl/transfer_stats.hpp>
 #include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <exception>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <stdexcept>
 #include <tuple>
 #include <utility>
+#include <vector>
+
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 
 #ifdef ASIOCURL_USE_BOOST_FUTURE
@@ -42,6 +63,29 @@ namespace asiocurl {
 	}
 
 
+	//	Exceptions are only created when an error must be reported
+	//	through a future, in Boost mode they must be thrown in such
+	//	a way that boost::current_exception can preserve their type
+	template <typename Exception>
+	static std::exception_ptr make_exception (Exception e) noexcept {
+
+		try {
+
+			#ifdef ASIOCURL_USE_BOOST_FUTURE
+			throw boost::enable_current_exception(std::move(e));
+			#else
+			return std::make_exception_ptr(std::move(e));
+			#endif
+
+		} catch (...) {
+
+			return std::current_exception();
+
+		}
+
+	}
+
+
 	static void multi_check (CURLMcode code) {
 
 		if (code!=CURLM_OK) throw multi_error(code);
@@ -56,399 +100,1739 @@ namespace asiocurl {
 	}
 
 
-	io_service::control::control () : stop_(false) {	}
+	io_service::handler_memory::handler_memory () noexcept {
 
+		for (auto && b : blocks_) b.in_use=false;
 
-	io_service::control::guard_type io_service::control::lock () const noexcept {
+	}
 
-		return guard_type(m_);
 
-	}
+	void * io_service::handler_memory::allocate (std::size_t size) {
 
+		if (size<=sizeof(block::storage)) for (auto && b : blocks_) {
 
-	io_service::control::operator bool () const noexcept {
+			bool expected=false;
+			if (b.in_use.compare_exchange_strong(expected,true,std::memory_order_acquire)) return b.storage;
+
+		}
 
-		return !stop_;
+		//	Either all blocks are in use (for example a cancelled
+		//	operation has not yet been reaped) or the handler is too
+		//	large, either way this is not the steady state
+		return ::operator new(size);
 
 	}
 
 
-	void io_service::control::stop () noexcept {
+	void io_service::handler_memory::deallocate (void * ptr) noexcept {
 
-		stop_=true;
+		for (auto && b : blocks_) if (ptr==b.storage) {
+
+			b.in_use.store(false,std::memory_order_release);
+			return;
+
+		}
+
+		::operator delete(ptr);
 
 	}
 
 
-	io_service::easy_state::easy_state (CURL * e) : easy(e) {	}
+	template <typename T>
+	class io_service::handler_allocator {
 
 
-	void io_service::easy_state::set_exception () noexcept {
+		template <typename>
+		friend class handler_allocator;
 
-		set_exception(std::current_exception());
 
-	}
+		private:
 
 
-	void io_service::easy_state::set_exception (std::exception_ptr ptr) noexcept {
+			handler_memory * memory_;
 
-		if (!ex) ex=std::move(ptr);
 
-	}
+		public:
 
 
-	io_service::socket_state::socket_state (const asio::ip::tcp::socket::protocol_type & protocol, asio::io_service & ios)
-		:	what(CURL_POLL_NONE),
-			read(false),
-			write(false),
-			closed(std::make_shared<bool>(false)),
-			socket(ios)
-	{
+			using value_type=T;
 
-		socket.open(protocol);
 
-	}
+			explicit handler_allocator (handler_memory & memory) noexcept : memory_(&memory) {	}
+			template <typename U>
+			handler_allocator (const handler_allocator<U> & rhs) noexcept : memory_(rhs.memory_) {	}
 
 
-	curl_socket_t io_service::open (void * clientp, curlsocktype purpose, struct curl_sockaddr * address) noexcept {
+			T * allocate (std::size_t n) {
 
-		if (purpose!=CURLSOCKTYPE_IPCXN) return CURL_SOCKET_BAD;
-		if ((address->family!=AF_INET) && (address->family!=AF_INET6)) return CURL_SOCKET_BAD;
+				return static_cast<T *>(memory_->allocate(sizeof(T)*n));
 
-		auto & self=*static_cast<io_service *>(clientp);
+			}
 
-		try {
 
-			socket_state ss((address->family==AF_INET) ? asio::ip::tcp::v4() : asio::ip::tcp::v6(),self.ios_);
-			auto native_handle=ss.socket.native_handle();
-			self.sockets_.emplace(native_handle,std::move(ss));
+			void deallocate (T * ptr, std::size_t) noexcept {
 
-			return native_handle;
+				memory_->deallocate(ptr);
 
-		} catch (...) {	}
+			}
 
-		return CURL_SOCKET_BAD;
 
-	}
+			template <typename U>
+			bool operator == (const handler_allocator<U> & rhs) const noexcept {
 
+				return memory_==rhs.memory_;
 
-	int io_service::close (void * clientp, curl_socket_t item) noexcept {
+			}
 
-		auto & self=*static_cast<io_service *>(clientp);
 
-		auto iter=self.sockets_.find(item);
-		*iter->second.closed=true;
-		self.sockets_.erase(iter);
-		
-		return 0;
+			template <typename U>
+			bool operator != (const handler_allocator<U> & rhs) const noexcept {
 
-	}
+				return memory_!=rhs.memory_;
 
+			}
 
-	static bool is_read (int what) noexcept {
 
-		switch (what) {
+	};
 
-			default:
-				break;
-			case CURL_POLL_IN:
-			case CURL_POLL_INOUT:
-				return true;
 
-		}
+	//	Causes ASIO to obtain the memory for the wrapped handler's
+	//	asynchronous operation from a handler_memory object, both
+	//	through the associated allocator and through the allocation
+	//	hooks (the latter are still consulted by handlers such as those
+	//	returned by asio::io_service::strand::wrap)
+	template <typename Handler>
+	class io_service::allocating_handler {
+
+
+		private:
+
+
+			handler_memory * memory_;
+			Handler h_;
+
+
+		public:
+
+
+			using allocator_type=handler_allocator<void>;
+
+
+			allocating_handler (handler_memory & memory, Handler h) : memory_(&memory), h_(std::move(h)) {	}
+
+
+			allocator_type get_allocator () const noexcept {
+
+				return allocator_type(*memory_);
+
+			}
+
+
+			template <typename... Args>
+			void operator () (Args &&... args) {
+
+				h_(std::forward<Args>(args)...);
+
+			}
+
+
+			friend void * asio_handler_allocate (std::size_t size, allocating_handler * self) {
+
+				return self->memory_->allocate(size);
+
+			}
+
+
+			friend void asio_handler_deallocate (void * ptr, std::size_t, allocating_handler * self) noexcept {
+
+				self->memory_->deallocate(ptr);
+
+			}
+
+
+	};
+
+
+	io_service::slot::slot () noexcept : generation(0), next(nullptr) {	}
+
+
+	io_service::control::control () noexcept : free_(nullptr), next(nullptr) {	}
 
-		return false;
+
+	io_service::control::guard_type io_service::control::lock () const noexcept {
+
+		return guard_type(m_);
 
 	}
 
 
-	static bool is_write (int what) noexcept {
+	io_service::slot & io_service::control::acquire () {
 
-		switch (what) {
+		auto l=lock();
 
-			default:
-				break;
-			case CURL_POLL_OUT:
-			case CURL_POLL_INOUT:
-				return true;
+		if (free_) {
+
+			auto & retr=*free_;
+			free_=retr.next;
+			return retr;
 
 		}
 
-		return false;
+		slots_.emplace_back();
+		return slots_.back();
 
 	}
 
 
-	int io_service::socket (CURL * easy, curl_socket_t socket, int what, void * userp, void *) noexcept {
+	void io_service::control::release (slot & s) noexcept {
 
-		switch (what) {
+		auto l=lock();
 
-			case CURL_POLL_OUT:
-			case CURL_POLL_IN:
-			case CURL_POLL_INOUT:
-				break;
-			//	Apparently libcurl will sometimes call this function
-			//	with CURL_POLL_REMOVE after it closes the socket
-			//
-			//	This violates the assumption we make below (i.e. that
-			//	the socket-in-question is valid)
-			default:
-				return 0;
+		//	Asynchronous operations may still refer to this slot,
+		//	this makes them stale, and since the memory they are
+		//	using is owned by this control object it may be reused
+		//	(it simply falls back to the heap if it is reused before
+		//	they complete)
+		++s.generation;
+		s.next=free_;
+		free_=&s;
 
-		}
+	}
 
-		auto & self=*static_cast<io_service *>(userp);
-		auto & s=self.handles_.find(easy)->second;
-		auto & ss=self.sockets_.find(socket)->second;
-		ss.what=what;
 
-		try {
+	class io_service::registry : public asio::io_service::service {
 
-			if (is_read(what) && !ss.read) self.read(ss);
 
-			if (is_write(what) && !ss.write) self.write(ss);
+		private:
 
-			return 0;
 
-		} catch (...) {
+			std::mutex m_;
+			std::deque<control> controls_;
+			control * free_;
 
-			s.set_exception();
 
-		}
+		public:
 
-		return -1;
 
-	}
+			static asio::io_service::id id;
 
 
-	int io_service::timer (CURLM *, long timeout_ms, void * userp) noexcept {
+			explicit registry (asio::io_service & ios) : asio::io_service::service(ios), free_(nullptr) {	}
 
-		auto & self=*static_cast<io_service *>(userp);
 
-		try {
+			control & acquire () {
 
-			self.timer_.cancel();
+				std::lock_guard<std::mutex> l(m_);
 
-			if (timeout_ms<=0) {
+				if (free_) {
 
-				self.do_action(CURL_SOCKET_TIMEOUT,0);
-				return 0;
+					auto & retr=*free_;
+					free_=retr.next;
+					return retr;
+
+				}
+
+				controls_.emplace_back();
+				return controls_.back();
 
 			}
 
-			std::chrono::milliseconds timeout_duration(timeout_ms);
-			auto timer_timeout=std::chrono::duration_cast<asio::steady_timer::duration>(timeout_duration);
-			self.timer_.expires_from_now(timer_timeout);
-			self.timer_.async_wait([&self,control=self.control_] (const auto &) {
 
-				auto l=control->lock();
-				if (!*control) return;
-				self.do_action(CURL_SOCKET_TIMEOUT,0);
+			void release (control & c) noexcept {
 
-			});
+				std::lock_guard<std::mutex> l(m_);
+				c.next=free_;
+				free_=&c;
 
-			return 0;
+			}
 
-		} catch (...) {	}
 
-		return -1;
+	};
+
+
+	asio::io_service::id io_service::registry::id;
+
+
+	void io_service::control_deleter::operator () (control * c) const noexcept {
+
+		r->release(*c);
 
 	}
 
 
-	void io_service::do_action (curl_socket_t socket, int mask) {
+	void io_service::slot_deleter::operator () (slot * s) const noexcept {
 
-		for (;;) {
+		c->release(*s);
 
-			int ignored;
-			auto result=curl_multi_socket_action(handle_,socket,mask,&ignored);
-			if (result==CURLM_CALL_MULTI_PERFORM) continue;
-			if (result==CURLM_OK) break;
-			throw multi_error(result);
+	}
 
-		}
 
-		for (;;) {
+	io_service::slot_ref::slot_ref (control & c, slot & s) noexcept : c_(&c), s_(&s), generation_(s.generation) {	}
 
-			int ignored;
-			auto ptr=curl_multi_info_read(handle_,&ignored);
-			if (ptr==nullptr) break;
-			if (ptr->msg!=CURLMSG_DONE) continue;
-			complete(*ptr);
 
-		}
+	io_service::control::guard_type io_service::slot_ref::lock () const noexcept {
+
+		return c_->lock();
 
 	}
 
 
-	void io_service::abort (easy_state & s) noexcept {
+	io_service::slot_ref::operator bool () const noexcept {
 
-		std::exception_ptr ex=s.ex;
-		if (!ex) try {
+		return s_->generation==generation_;
 
-			#ifdef ASIOCURL_USE_BOOST_FUTURE
-			throw boost::enable_current_exception(aborted{});
-			#else
-			ex=std::make_exception_ptr(aborted{});
-			#endif
+	}
 
-		} catch (...) {
 
-			ex=std::current_exception();
+	io_service::completion::completion () noexcept : invoke_(nullptr), relocate_(nullptr), destroy_(nullptr) {	}
 
-		}
 
-		set_exception(s.promise,std::move(ex));
+	io_service::completion::completion (completion && rhs) noexcept : invoke_(rhs.invoke_), relocate_(rhs.relocate_), destroy_(rhs.destroy_) {
 
-		//	This may throw into noexcept, it should never happen
-		//	as far as I'm concerned, but it's better to fail
-		//	fast and in the correct place when/if it does
-		multi_check(curl_multi_remove_handle(handle_,s.easy));
+		if (invoke_) relocate_(rhs,*this);
+		rhs.invoke_=nullptr;
 
 	}
 
 
-	void io_service::abort (handles_type::iterator iter) noexcept {
+	io_service::completion & io_service::completion::operator = (completion && rhs) noexcept {
 
-		abort(iter->second);
+		if (this==&rhs) return *this;
 
-		//	This will cause the easy handle to be cleaned up,
-		//	which should cause all sockets to be closed, this will
-		//	prevent any pending asynchronous callbacks from accessing
-		//	the easy handle
-		handles_.erase(iter);
+		if (invoke_) destroy_(*this);
+		invoke_=rhs.invoke_;
+		relocate_=rhs.relocate_;
+		destroy_=rhs.destroy_;
+		if (invoke_) relocate_(rhs,*this);
+		rhs.invoke_=nullptr;
+
+		return *this;
 
 	}
 
 
-	void io_service::complete (CURLMsg msg) noexcept {
+	io_service::completion::~completion () noexcept {
 
-		auto iter=handles_.find(msg.easy_handle);
-		auto & s=iter->second;
-		if (s.ex) set_exception(s.promise,std::move(s.ex));
-		else s.promise.set_value(msg);
-		handles_.erase(iter);
+		if (invoke_) destroy_(*this);
 
 	}
 
 
-	void io_service::read (socket_state & ss) {
+	io_service::completion::operator bool () const noexcept {
 
-		ss.socket.async_read_some(asio::null_buffers{},[&,control=control_,closed=ss.closed] (const auto & ec, auto) {
+		return invoke_!=nullptr;
 
-			auto l=control->lock();
-			if (!*control) return;
-			if (*closed) return;
-			ss.read=false;
+	}
 
-			int mask=CURL_CSELECT_IN;
-			if (ec) mask|=CURL_CSELECT_ERR;
-			this->do_action(ss.socket.native_handle(),mask);
 
-		});
-		ss.read=true;
+	void io_service::completion::operator () (error_code ec, const CURLMsg & msg) {
+
+		//	The callable is destroyed as part of being invoked
+		auto invoke=invoke_;
+		invoke_=nullptr;
+		invoke(*this,ec,msg);
 
 	}
 
 
-	void io_service::write (socket_state & ss) {
+	io_service::easy_state::easy_state (CURL * e) : easy(e), priv(nullptr), shared(false), queued(false), level(priority::normal), failed(false) {	}
 
-		ss.socket.async_write_some(asio::null_buffers{},[&,control=control_,closed=ss.closed] (const auto & ec, auto) {
 
-			auto l=control->lock();
-			if (!*control) return;
-			if (*closed) return;
-			ss.write=false;
+	void io_service::easy_state::fail (error_code e) noexcept {
 
-			int mask=CURL_CSELECT_OUT;
-			if (ec) mask|=CURL_CSELECT_ERR;
-			this->do_action(ss.socket.native_handle(),mask);
+		if (!ec) ec=e;
 
-		});
-		ss.write=true;
+	}
+
+
+	void io_service::easy_state::restore () noexcept {
+
+		//	This cannot fail: libcurl merely stores the pointer
+		curl_easy_setopt(easy,CURLOPT_PRIVATE,priv);
+		//	The easy handle is no longer associated with a multi
+		//	handle so detaching it cannot fail
+		if (shared) curl_easy_setopt(easy,CURLOPT_SHARE,static_cast<CURLSH *>(nullptr));
 
 	}
 
 
-	io_service::io_service (asio::io_service & ios) : ios_(ios), control_(std::make_shared<control>()), timer_(ios) {
+	io_service::socket_state::socket_state (const asio::generic::stream_protocol & protocol, asio::io_service & ios, control & c)
+		:	what(CURL_POLL_NONE),
+			read(false),
+			write(false),
+			generation(0),
+			ready(0),
+			foreign(false),
+			slot(&c.acquire(),slot_deleter{&c}),
+			socket(ios)
+	{
+
+		socket.open(protocol);
+		native=socket.native_handle();
+
+	}
 
-		if (!(handle_=curl_multi_init())) throw error("curl_multi_init failed");
-		auto g=make_scope_exit([&] () noexcept {	multi_check(curl_multi_cleanup(handle_));	});
 
-		//	Install our handlers
-		multi_check(curl_multi_setopt(handle_,CURLMOPT_SOCKETFUNCTION,&socket));
-		multi_check(curl_multi_setopt(handle_,CURLMOPT_SOCKETDATA,this));
-		multi_check(curl_multi_setopt(handle_,CURLMOPT_TIMERFUNCTION,&timer));
-		multi_check(curl_multi_setopt(handle_,CURLMOPT_TIMERDATA,this));
+	io_service::socket_state::socket_state (curl_socket_t s, asio::io_service & ios, control & c)
+		:	what(CURL_POLL_NONE),
+			read(false),
+			write(false),
+			generation(0),
+			ready(0),
+			foreign(true),
+			slot(&c.acquire(),slot_deleter{&c}),
+			socket(ios),
+			native(s)
+	{
 
+		//	The descriptor belongs to libcurl which will close it
+		//	without telling us, so we wait on a duplicate which we
+		//	own instead
+	#ifdef _WIN32
+		//	Only sockets may be duplicated (and waited upon) on
+		//	Windows, the descriptors libcurl waits on there (such
+		//	as its resolver's socketpair) are all sockets
+		WSAPROTOCOL_INFOW info;
+		if (::WSADuplicateSocketW(s,::GetCurrentProcessId(),&info)!=0) throw system_error(error_code(::WSAGetLastError(),asio::error::get_system_category()));
+		auto fd=::WSASocketW(FROM_PROTOCOL_INFO,FROM_PROTOCOL_INFO,FROM_PROTOCOL_INFO,&info,0,WSA_FLAG_OVERLAPPED);
+		if (fd==INVALID_SOCKET) throw system_error(error_code(::WSAGetLastError(),asio::error::get_system_category()));
+		auto g=make_scope_exit([&] () noexcept {	::closesocket(fd);	});
+	#else
+		auto fd=::dup(s);
+		if (fd<0) throw system_error(error_code(errno,asio::error::get_system_category()));
+		auto g=make_scope_exit([&] () noexcept {	::close(fd);	});
+	#endif
+		//	What sort of descriptor this is is unknown, but the
+		//	protocol is only needed to open sockets and to
+		//	interpret their addresses neither of which we do
+		socket.assign(asio::generic::stream_protocol(AF_UNSPEC,0),fd);
 		g.release();
 
 	}
 
 
-	io_service::~io_service () noexcept {
+	io_service::recorder::recorder () noexcept
+		:	started(0),
+			completed(0),
+			aborted(0),
+			bytes_in(0),
+			bytes_out(0),
+			wakeups(0),
+			actions(0),
+			timer_updates(0),
+			timer_waits(0),
+			timer_posts(0),
+			reaps(0),
+			flushes(0)
+	{	}
 
-		auto l=control_->lock();
-		//	Destroy all the easy handles to abort all
-		//	transfers
-		for (auto && pair : handles_) abort(pair.second);
-		handles_.clear();
 
-		//	Make sure callbacks abort as soon as they're
-		//	fired
-		control_->stop();
+	void io_service::recorder::add (std::atomic<std::uint64_t> & counter, std::uint64_t n) noexcept {
 
-		//	This should never throw, but if it does
-		//	it's better to fail fast than to silently
-		//	continue
-		multi_check(curl_multi_cleanup(handle_));
+		//	Writers are serialized by the lock so a locked
+		//	read-modify-write is unnecessary
+		counter.store(counter.load(std::memory_order_relaxed)+n,std::memory_order_relaxed);
 
 	}
 
 
-	future<CURLMsg> io_service::add (CURL * easy) {
+	void io_service::recorder::record (const transfer_stats & stats) noexcept {
 
-		auto l=control_->lock();
+		if (stats.downloaded>0) add(bytes_in,static_cast<std::uint64_t>(stats.downloaded));
+		if (stats.uploaded>0) add(bytes_out,static_cast<std::uint64_t>(stats.uploaded));
+		name_lookup.record(stats.name_lookup);
+		connect.record(stats.connect);
+		app_connect.record(stats.app_connect);
+		start_transfer.record(stats.start_transfer);
+		total.record(stats.total);
 
-		auto pair=handles_.emplace(std::piecewise_construct,std::forward_as_tuple(easy),std::forward_as_tuple(easy));
-		if (!pair.second) throw std::logic_error("Attempt to add duplicate easy handle");
-		auto iter=pair.first;
-		auto g=make_scope_exit([&] () noexcept {	handles_.erase(iter);	});
-		auto & s=iter->second;
-		auto retr=s.promise.get_future();
+	}
 
-		easy_check(curl_easy_setopt(s.easy,CURLOPT_OPENSOCKETFUNCTION,&open));
-		easy_check(curl_easy_setopt(s.easy,CURLOPT_OPENSOCKETDATA,this));
-		easy_check(curl_easy_setopt(s.easy,CURLOPT_CLOSESOCKETFUNCTION,&close));
-		easy_check(curl_easy_setopt(s.easy,CURLOPT_CLOSESOCKETDATA,this));
 
-		//	This should invoke the proper callbacks to get things
-		//	rolling
-		multi_check(curl_multi_add_handle(handle_,easy));
+	void io_service::recorder::snapshot (asiocurl::metrics & m) const noexcept {
+
+		m.started=started.load(std::memory_order_relaxed);
+		m.completed=completed.load(std::memory_order_relaxed);
+		m.aborted=aborted.load(std::memory_order_relaxed);
+		m.bytes_in=bytes_in.load(std::memory_order_relaxed);
+		m.bytes_out=bytes_out.load(std::memory_order_relaxed);
+		m.wakeups=wakeups.load(std::memory_order_relaxed);
+		m.actions=actions.load(std::memory_order_relaxed);
+		m.timer_updates=timer_updates.load(std::memory_order_relaxed);
+		m.timer_waits=timer_waits.load(std::memory_order_relaxed);
+		m.timer_posts=timer_posts.load(std::memory_order_relaxed);
+		m.reaps=reaps.load(std::memory_order_relaxed);
+		m.flushes=flushes.load(std::memory_order_relaxed);
+		m.name_lookup=name_lookup.snapshot();
+		m.connect=connect.snapshot();
+		m.app_connect=app_connect.snapshot();
+		m.start_transfer=start_transfer.snapshot();
+		m.total=total.snapshot();
 
-		g.release();
+	}
 
-		return retr;
 
-	}
+	template <typename Operation, typename Handler>
+	void io_service::async (Operation op, handler_memory & memory, Handler h) {
 
+		allocating_handler<Handler> ah(memory,std::move(h));
+		if (strand_) op(strand_->wrap(std::move(ah)));
+		else op(std::move(ah));
 
-	bool io_service::remove (CURL * easy) noexcept {
+	}
 
-		auto l=control_->lock();
 
-		auto iter=handles_.find(easy);
-		if (iter==handles_.end()) return false;
+	io_service::slot_ref io_service::ref (const slot_ptr & s) const noexcept {
 
-		abort(iter);
-		return true;
+		return slot_ref(*control_,*s);
 
 	}
 
 
-	asio::io_service & io_service::get_io_service () const noexcept {
+	curl_socket_t io_service::open (void * clientp, curlsocktype purpose, struct curl_sockaddr * address) noexcept {
 
-		return ios_;
+		if (purpose!=CURLSOCKTYPE_IPCXN) return CURL_SOCKET_BAD;
+		if (address->socktype!=SOCK_STREAM) return CURL_SOCKET_BAD;
+		switch (address->family) {
+
+			default:
+				return CURL_SOCKET_BAD;
+			case AF_INET:
+			case AF_INET6:
+			//	CURLOPT_UNIX_SOCKET_PATH
+			#ifdef AF_UNIX
+			case AF_UNIX:
+			#endif
+				break;
+
+		}
+
+		auto & self=*static_cast<io_service *>(clientp);
+
+		try {
+
+			socket_state ss(asio::generic::stream_protocol(address->family,address->protocol),self.ios_,*self.control_);
+			auto native_handle=ss.socket.native_handle();
+			//	Any entry for this descriptor belongs to a foreign
+			//	socket which libcurl has since closed
+			self.sockets_.erase(native_handle);
+			self.sockets_.emplace(native_handle,std::move(ss));
+
+			return native_handle;
+
+		} catch (...) {	}
+
+		return CURL_SOCKET_BAD;
+
+	}
+
+
+	int io_service::close (void * clientp, curl_socket_t item) noexcept {
+
+		auto & self=*static_cast<io_service *>(clientp);
+
+		auto iter=self.sockets_.find(item);
+		//	libcurl may still refer to this socket, make sure it
+		//	does not pass a dangling pointer back to the socket
+		//	callback
+		curl_multi_assign(self.handle_,item,nullptr);
+		self.sockets_.erase(iter);
+		
+		return 0;
+
+	}
+
+
+	static bool is_read (int what) noexcept {
+
+		switch (what) {
+
+			default:
+				break;
+			case CURL_POLL_IN:
+			case CURL_POLL_INOUT:
+				return true;
+
+		}
+
+		return false;
+
+	}
+
+
+	//	The number of times a readable socket is serviced before
+	//	control is returned to the reactor
+	static constexpr std::size_t max_reads=16;
+
+
+	static bool readable (asio::generic::stream_protocol::socket & socket) noexcept {
+
+		error_code ec;
+		auto n=socket.available(ec);
+
+		return !ec && (n!=0);
+
+	}
+
+
+	static bool is_write (int what) noexcept {
+
+		switch (what) {
+
+			default:
+				break;
+			case CURL_POLL_OUT:
+			case CURL_POLL_INOUT:
+				return true;
+
+		}
+
+		return false;
+
+	}
+
+
+	int io_service::socket (CURL * easy, curl_socket_t socket, int what, void * userp, void * socketp) noexcept {
+
+		auto & self=*static_cast<io_service *>(userp);
+		auto ss=static_cast<socket_state *>(socketp);
+
+		switch (what) {
+
+			case CURL_POLL_OUT:
+			case CURL_POLL_IN:
+			case CURL_POLL_INOUT:
+				break;
+			//	Apparently libcurl will sometimes call this function
+			//	with CURL_POLL_REMOVE after it closes the socket
+			//
+			//	This violates the assumption we make below (i.e. that
+			//	the socket-in-question is valid)
+			default:
+				//	If the socket is still open (for example an idle
+				//	connection libcurl keeps for reuse) stop waiting on
+				//	it so that it does not wake the io_service for
+				//	nothing
+				if (ss) {
+
+					ss->what=CURL_POLL_NONE;
+					cancel(*ss);
+					//	libcurl does not tell us when it closes foreign
+					//	sockets, so this is the last we hear of them
+					if (ss->foreign) {
+
+						curl_multi_assign(self.handle_,socket,nullptr);
+						self.sockets_.erase(socket);
+
+					}
+
+				}
+				return 0;
+
+		}
+
+		//	The first time libcurl tells us about a socket its
+		//	state is associated therewith so that subsequent
+		//	invocations need not look it up
+		if (!ss) {
+
+			auto iter=self.sockets_.find(socket);
+			//	libcurl also waits on descriptors it did not open
+			//	through the open callback (for example the socketpair
+			//	by which its threaded resolver signals that a name has
+			//	been resolved)
+			if (iter==self.sockets_.end()) try {
+
+				iter=self.sockets_.emplace(socket,socket_state(socket,self.ios_,*self.control_)).first;
+
+			} catch (...) {
+
+				state(easy).fail(to_error_code(std::current_exception()));
+				return -1;
+
+			}
+			ss=&iter->second;
+			auto code=curl_multi_assign(self.handle_,socket,ss);
+			if (code!=CURLM_OK) {
+
+				state(easy).fail(make_error_code(code));
+				return -1;
+
+			}
+
+		}
+
+		ss->what=what;
+		//	Waits for events libcurl is no longer interested in (for
+		//	example after a transition from CURL_POLL_INOUT to
+		//	CURL_POLL_IN) are cancelled, those which are still wanted
+		//	are restarted below
+		if ((ss->read && !is_read(what)) || (ss->write && !is_write(what))) cancel(*ss);
+
+		//	Starting an asynchronous operation only fails if memory
+		//	cannot be allocated
+		try {
+
+			if (is_read(what) && !ss->read) self.read(*ss);
+
+			if (is_write(what) && !ss->write) self.write(*ss);
+
+			return 0;
+
+		} catch (...) {
+
+			state(easy).fail(to_error_code(std::current_exception()));
+
+		}
+
+		return -1;
+
+	}
+
+
+	int io_service::timer (CURLM *, long timeout_ms, void * userp) noexcept {
+
+		auto & self=*static_cast<io_service *>(userp);
+		recorder::add(self.recorder_.timer_updates);
+
+		try {
+
+			if (timeout_ms<0) {
+
+				//	The outstanding wait (if any) is left alone and
+				//	does nothing when it fires
+				self.deadline_=asio::steady_timer::time_point::max();
+				return 0;
+
+			}
+
+			if (timeout_ms==0) {
+
+				self.deadline_=asio::steady_timer::time_point::max();
+				if (self.batching_) {
+
+					self.kick_=true;
+					return 0;
+
+				}
+
+				//	Acting immediately would reenter libcurl (this is
+				//	invoked from within curl_multi_add_handle amongst
+				//	others) which it does not support
+				self.post_action();
+				return 0;
+
+			}
+
+			std::chrono::milliseconds timeout_duration(timeout_ms);
+			self.deadline_=asio::steady_timer::clock_type::now()+std::chrono::duration_cast<asio::steady_timer::duration>(timeout_duration);
+			if (!self.batching_) self.schedule();
+
+			return 0;
+
+		} catch (...) {	}
+
+		return -1;
+
+	}
+
+
+	io_service::easy_state & io_service::state (CURL * easy) noexcept {
+
+		char * ptr;
+		//	This cannot fail: The easy handle is managed by this
+		//	io_service and therefore CURLOPT_PRIVATE is set
+		curl_easy_getinfo(easy,CURLINFO_PRIVATE,&ptr);
+
+		return *static_cast<easy_state *>(static_cast<void *>(ptr));
+
+	}
+
+
+	int io_service::socket_action (curl_socket_t socket, int mask, error_code & ec) noexcept {
+
+		for (;;) {
+
+			int running;
+			recorder::add(recorder_.actions);
+			auto result=curl_multi_socket_action(handle_,socket,mask,&running);
+			if (result==CURLM_CALL_MULTI_PERFORM) continue;
+			if (result==CURLM_OK) return running;
+			ec=make_error_code(result);
+			return -1;
+
+		}
+
+	}
+
+
+	void io_service::reap (int running) noexcept {
+
+		//	Transfers are removed from the multi handle as soon as
+		//	libcurl reports them as done, so every transfer therein
+		//	is either running or has a message waiting to be read,
+		//	unless fewer are running than are in the multi handle
+		//	there is nothing to read
+		if (static_cast<std::size_t>(running)>=in_flight_) return;
+		recorder::add(recorder_.reaps);
+
+		for (;;) {
+
+			int ignored;
+			auto ptr=curl_multi_info_read(handle_,&ignored);
+			if (ptr==nullptr) break;
+			if (ptr->msg!=CURLMSG_DONE) continue;
+			complete(*ptr);
+
+		}
+
+	}
+
+
+	void io_service::do_action (curl_socket_t socket, int mask) noexcept {
+
+		error_code ec;
+		auto running=socket_action(socket,mask,ec);
+		if (ec) fail(ec);
+		else reap(running);
+
+	}
+
+
+	void io_service::fail (error_code ec) noexcept {
+
+		//	An action which fails leaves libcurl unable to make
+		//	progress with any transfer in the multi handle, transfers
+		//	which are queued never reached libcurl and are admitted
+		//	as the others are removed
+		for (auto && pair : handles_) if (!pair.second.queued) {
+
+			pair.second.fail(ec);
+			pair.second.failed=true;
+
+		}
+
+		//	The handlers may add and remove transfers and thereby
+		//	invalidate any iterator, so the search starts over after
+		//	each transfer is aborted
+		for (;;) {
+
+			auto iter=std::find_if(handles_.begin(),handles_.end(),[] (const auto & pair) noexcept {	return pair.second.failed;	});
+			if (iter==handles_.end()) break;
+			abort(iter);
+
+		}
+
+	}
+
+
+	void io_service::abort (handles_type::iterator iter) noexcept {
+
+		auto & s=iter->second;
+		auto queued=s.queued;
+		if (queued) {
+
+			auto & q=queues_[static_cast<std::size_t>(s.level)];
+			q.erase(std::find(q.begin(),q.end(),s.easy));
+			--queued_;
+
+		} else {
+
+			//	This should never fail, if it does the transfer is
+			//	reported as having failed for that reason
+			auto result=curl_multi_remove_handle(handle_,s.easy);
+			if (result!=CURLM_OK) s.fail(make_error_code(result));
+			--in_flight_;
+
+		}
+		s.restore();
+		auto ec=s.ec;
+		if (!ec) ec=asio::error::operation_aborted;
+
+		CURLMsg msg{};
+		msg.easy_handle=s.easy;
+		auto h=std::move(s.handler);
+		//	This will cause the easy handle to be cleaned up,
+		//	which should cause all sockets to be closed, this will
+		//	prevent any pending asynchronous callbacks from accessing
+		//	the easy handle
+		handles_.erase(iter);
+		size_=handles_.size();
+		recorder::add(recorder_.aborted);
+
+		//	Waiting transfers are admitted before the handler runs
+		//	so that transfers it adds queue behind them
+		if (!queued) promote();
+		h(ec,msg);
+
+	}
+
+
+	void io_service::complete (CURLMsg msg) noexcept {
+
+		auto iter=handles_.find(msg.easy_handle);
+		auto & s=iter->second;
+		//	The easy handle must be disassociated from the multi
+		//	handle before the transfer is reported as complete
+		//	otherwise the caller could not reuse it
+		//
+		//	As in abort this should never fail
+		auto result=curl_multi_remove_handle(handle_,s.easy);
+		if (result!=CURLM_OK) s.fail(make_error_code(result));
+		--in_flight_;
+		recorder::add(recorder_.completed);
+		if (instrument_) recorder_.record(transfer_stats::capture(s.easy));
+		s.restore();
+		auto ec=s.ec;
+		auto h=std::move(s.handler);
+		handles_.erase(iter);
+		size_=handles_.size();
+		promote();
+		h(ec,msg);
+
+	}
+
+
+	void io_service::read (socket_state & ss) {
+
+		async([&] (auto h) {	ss.socket.async_wait(asio::socket_base::wait_read,std::move(h));	},ss.slot->memory,[&,r=ref(ss.slot),g=ss.generation] (const auto & ec) {
+
+			auto l=r.lock();
+			if (!r || (ss.generation!=g)) return;
+			ss.read=false;
+			recorder::add(this->recorder_.wakeups);
+
+			int mask=CURL_CSELECT_IN;
+			if (ec) mask|=CURL_CSELECT_ERR;
+			try {
+
+				if (this->batch_events_) {
+
+					this->ready(ss,r,mask);
+					return;
+
+				}
+				error_code e;
+				auto running=this->service(ss,r,mask,e);
+				if (e) this->fail(e);
+				else this->reap(running);
+
+				//	libcurl only invokes the socket callback when the
+				//	events it is interested in change, so if it is still
+				//	interested in this event it must be waited for again
+				if (!r) return;
+				if (is_read(ss.what) && !ss.read) this->read(ss);
+
+			} catch (...) {
+
+				//	If the socket cannot be waited upon the transfers
+				//	using it would never finish
+				this->fail(to_error_code(std::current_exception()));
+
+			}
+
+		});
+		ss.read=true;
+
+	}
+
+
+	void io_service::write (socket_state & ss) {
+
+		async([&] (auto h) {	ss.socket.async_wait(asio::socket_base::wait_write,std::move(h));	},ss.slot->memory,[&,r=ref(ss.slot),g=ss.generation] (const auto & ec) {
+
+			auto l=r.lock();
+			if (!r || (ss.generation!=g)) return;
+			ss.write=false;
+			recorder::add(this->recorder_.wakeups);
+
+			int mask=CURL_CSELECT_OUT;
+			if (ec) mask|=CURL_CSELECT_ERR;
+			try {
+
+				if (this->batch_events_) {
+
+					this->ready(ss,r,mask);
+					return;
+
+				}
+				error_code e;
+				auto running=this->service(ss,r,mask,e);
+				if (e) this->fail(e);
+				else this->reap(running);
+
+				//	libcurl only invokes the socket callback when the
+				//	events it is interested in change, so if it is still
+				//	interested in this event it must be waited for again
+				if (!r) return;
+				if (is_write(ss.what) && !ss.write) this->write(ss);
+
+			} catch (...) {
+
+				//	If the socket cannot be waited upon the transfers
+				//	using it would never finish
+				this->fail(to_error_code(std::current_exception()));
+
+			}
+
+		});
+		ss.write=true;
+
+	}
+
+
+	void io_service::cancel (socket_state & ss) noexcept {
+
+		//	Events which occurred but have not yet been serviced
+		//	are no longer of interest either
+		ss.ready=0;
+		if (!(ss.read || ss.write)) return;
+
+		//	ASIO can only cancel all the waits on a socket at once
+		error_code ignored;
+		ss.socket.cancel(ignored);
+		++ss.generation;
+		ss.read=false;
+		ss.write=false;
+
+	}
+
+
+	int io_service::service (socket_state & ss, const slot_ref & r, int mask, error_code & ec) noexcept {
+
+		//	libcurl does not recognize the duplicates by which
+		//	foreign sockets are waited upon
+		auto socket=ss.native;
+		auto running=socket_action(socket,mask,ec);
+
+		//	libcurl consumes at most one buffer per action, rather
+		//	than going back through the reactor for each buffer of
+		//	a long response the socket is serviced for as long as
+		//	it remains readable and libcurl remains interested in
+		//	it, up to a limit so that other sockets are not starved
+		if ((mask&CURL_CSELECT_IN) && !(mask&CURL_CSELECT_ERR)) for (std::size_t i=1;(i<max_reads) && !ec && r && is_read(ss.what) && !ss.read && readable(ss.socket);++i) running=socket_action(socket,CURL_CSELECT_IN,ec);
+
+		return running;
+
+	}
+
+
+	void io_service::ready (socket_state & ss, const slot_ref & r, int mask) {
+
+		if (ss.ready==0) ready_.push_back(readiness{&ss,r});
+		ss.ready|=mask;
+
+		//	When one thread runs the asio::io_service the reactor
+		//	queues the handlers for all the sockets which became
+		//	ready during a pass before any of them run, so the flush
+		//	posted by the first runs after the last, otherwise it may
+		//	run sooner and the remainder are flushed later (see
+		//	options::batch_events)
+		if (flush_posted_) return;
+		async([&] (auto h) {	asio::post(ios_,std::move(h));	},slot_->memory,[this,r=ref(slot_)] () {
+
+			auto l=r.lock();
+			if (!r) return;
+			flush_posted_=false;
+			try {
+
+				flush();
+
+			} catch (...) {
+
+				fail(to_error_code(std::current_exception()));
+
+			}
+
+		});
+		flush_posted_=true;
+
+	}
+
+
+	void io_service::flush () {
+
+		recorder::add(recorder_.flushes);
+		flushing_.swap(ready_);
+		auto g=make_scope_exit([&] () noexcept {
+
+			for (auto && e : flushing_) if (e.r) e.ss->ready=0;
+			flushing_.clear();
+
+		});
+
+		int running=-1;
+		error_code ec;
+		for (auto && e : flushing_) {
+
+			if (!e.r) continue;
+			auto mask=e.ss->ready;
+			if (mask==0) continue;
+			e.ss->ready=0;
+			running=service(*e.ss,e.r,mask,ec);
+			if (ec) break;
+
+		}
+		if (ec) fail(ec);
+		else if (running>=0) reap(running);
+
+		//	As in read and write the events libcurl is still
+		//	interested in must be waited for again
+		for (auto && e : flushing_) {
+
+			if (!e.r) continue;
+			auto & ss=*e.ss;
+			if (is_read(ss.what) && !ss.read) read(ss);
+			if (is_write(ss.what) && !ss.write) write(ss);
+
+		}
+
+	}
+
+
+	bool io_service::admit () const noexcept {
+
+		return (max_in_flight_==0) || (in_flight_<max_in_flight_);
+
+	}
+
+
+	void io_service::promote () noexcept {
+
+		for (auto && q : queues_) while (!q.empty() && admit()) {
+
+			auto iter=handles_.find(q.front());
+			q.pop_front();
+			--queued_;
+			auto & s=iter->second;
+			//	The transfer is accounted for as being in flight
+			//	before it is added since it is no longer in a queue,
+			//	if adding it fails abort treats it as in flight and
+			//	therefore undoes this (libcurl no longer reenters
+			//	this function from within curl_multi_add_handle since
+			//	zero timeouts are posted rather than acted upon)
+			s.queued=false;
+			++in_flight_;
+			auto result=curl_multi_add_handle(handle_,s.easy);
+			if (result==CURLM_OK) continue;
+			s.fail(make_error_code(result));
+			abort(iter);
+
+		}
+
+	}
+
+
+	void io_service::insert (CURL * easy, completion & c, priority p) {
+
+		auto pair=handles_.emplace(std::piecewise_construct,std::forward_as_tuple(easy),std::forward_as_tuple(easy));
+		if (!pair.second) throw std::logic_error("Attempt to add duplicate easy handle");
+		auto iter=pair.first;
+		auto & s=iter->second;
+		s.handler=std::move(c);
+		auto g=make_scope_exit([&] () noexcept {
+
+			s.restore();
+			c=std::move(s.handler);
+			handles_.erase(iter);
+
+		});
+
+		easy_check(curl_easy_getinfo(s.easy,CURLINFO_PRIVATE,&s.priv));
+		easy_check(curl_easy_setopt(s.easy,CURLOPT_PRIVATE,static_cast<void *>(&s)));
+		easy_check(curl_easy_setopt(s.easy,CURLOPT_OPENSOCKETFUNCTION,&open));
+		easy_check(curl_easy_setopt(s.easy,CURLOPT_OPENSOCKETDATA,this));
+		easy_check(curl_easy_setopt(s.easy,CURLOPT_CLOSESOCKETFUNCTION,&close));
+		easy_check(curl_easy_setopt(s.easy,CURLOPT_CLOSESOCKETDATA,this));
+		if (share_) {
+
+			easy_check(curl_easy_setopt(s.easy,CURLOPT_SHARE,share_->native_handle()));
+			s.shared=true;
+
+		}
+		s.level=p;
+
+		if (!admit()) {
+
+			queues_[static_cast<std::size_t>(p)].push_back(easy);
+			s.queued=true;
+			++queued_;
+
+		} else {
+
+			//	This should invoke the proper callbacks to get things
+			//	rolling
+			multi_check(curl_multi_add_handle(handle_,easy));
+			++in_flight_;
+
+		}
+
+		g.release();
+		size_=handles_.size();
+		recorder::add(recorder_.started);
+
+	}
+
+
+	//	How late the timer may fire rather than being restarted
+	//	when libcurl moves its deadline earlier, libcurl's timeouts
+	//	have a resolution of one millisecond anyway
+	static constexpr std::chrono::milliseconds timer_tolerance(1);
+
+
+	void io_service::schedule () {
+
+		if (deadline_==asio::steady_timer::time_point::max()) return;
+		//	libcurl moves the deadline very frequently (typically
+		//	later), cancelling and restarting the wait each time would
+		//	leave behind cancelled operations each of which holds
+		//	handler memory until it is reaped, therefore the wait
+		//	is only restarted if it would otherwise fire too late
+		if (waiting_ && (timer_.expiry()<=(deadline_+timer_tolerance))) return;
+		wait();
+
+	}
+
+
+	void io_service::post_action () {
+
+		//	Any number of requests for an immediate timeout before
+		//	the posted action runs are satisfied by that one action
+		if (posted_) return;
+		async([&] (auto h) {	asio::post(ios_,std::move(h));	},slot_->memory,[this,r=ref(slot_)] () {
+
+			auto l=r.lock();
+			if (!r) return;
+			posted_=false;
+			do_action(CURL_SOCKET_TIMEOUT,0);
+
+		});
+		posted_=true;
+		recorder::add(recorder_.timer_posts);
+
+	}
+
+
+	void io_service::wait () {
+
+		timer_.expires_at(deadline_);
+		waiting_=true;
+		recorder::add(recorder_.timer_waits);
+		async([&] (auto h) {	timer_.async_wait(std::move(h));	},slot_->memory,[this,r=ref(slot_)] (const auto & ec) {
+
+			auto l=r.lock();
+			if (!r) return;
+			//	Superseded by a later call to wait
+			if (ec==asio::error::operation_aborted) return;
+			waiting_=false;
+			if (deadline_==asio::steady_timer::time_point::max()) return;
+			//	The deadline was moved later while this wait
+			//	was outstanding
+			if (asio::steady_timer::clock_type::now()<deadline_) {
+
+				try {
+
+					wait();
+
+				} catch (...) {
+
+					//	Without the timer libcurl's timeouts would
+					//	never be acted upon
+					fail(to_error_code(std::current_exception()));
+
+				}
+				return;
+
+			}
+			deadline_=asio::steady_timer::time_point::max();
+			do_action(CURL_SOCKET_TIMEOUT,0);
+
+		});
+
+	}
+
+
+	io_service::io_service (asio::io_service & ios, serialization s)
+		:	ios_(ios),
+			size_(0),
+			control_(&asio::use_service<registry>(ios).acquire(),control_deleter{&asio::use_service<registry>(ios)}),
+			slot_(&control_->acquire(),slot_deleter{control_.get()}),
+			timer_(ios),
+			deadline_(asio::steady_timer::time_point::max()),
+			waiting_(false),
+			batching_(false),
+			kick_(false),
+			posted_(false),
+			share_(nullptr),
+			max_in_flight_(0),
+			in_flight_(0),
+			queued_(0),
+			instrument_(false),
+			batch_events_(false),
+			flush_posted_(false)
+	{
+
+		if (s==serialization::strand) strand_.emplace(ios);
+
+		if (!(handle_=curl_multi_init())) throw error("curl_multi_init failed");
+		auto g=make_scope_exit([&] () noexcept {	curl_multi_cleanup(handle_);	});
+
+		//	Install our handlers
+		multi_check(curl_multi_setopt(handle_,CURLMOPT_SOCKETFUNCTION,&socket));
+		multi_check(curl_multi_setopt(handle_,CURLMOPT_SOCKETDATA,this));
+		multi_check(curl_multi_setopt(handle_,CURLMOPT_TIMERFUNCTION,&timer));
+		multi_check(curl_multi_setopt(handle_,CURLMOPT_TIMERDATA,this));
+
+		g.release();
+
+	}
+
+
+	io_service::io_service (asio::io_service & ios, share & sh, serialization s) : io_service(ios,s) {
+
+		share_=&sh;
+
+	}
+
+
+	io_service::io_service (asio::io_service & ios, const options & o, serialization s) : io_service(ios,s) {
+
+		apply(o);
+
+	}
+
+
+	io_service::io_service (asio::io_service & ios, share & sh, const options & o, serialization s) : io_service(ios,sh,s) {
+
+		apply(o);
+
+	}
+
+
+	io_service::~io_service () noexcept {
+
+		auto l=control_->lock();
+		//	Waiting transfers are aborted first so that aborting
+		//	transfers in flight does not admit them
+		for (auto && q : queues_) while (!q.empty()) abort(handles_.find(q.front()));
+		//	Destroy all the easy handles to abort all
+		//	transfers
+		while (!handles_.empty()) abort(handles_.begin());
+
+		//	There are no transfers left to which a failure
+		//	could be reported
+		curl_multi_cleanup(handle_);
+		sockets_.clear();
+
+		//	Make sure callbacks abort as soon as they're
+		//	fired
+		slot_.reset();
+
+	}
+
+
+	void io_service::start (CURL * easy, completion & c, priority p) {
+
+		if (strand_ && !strand_->running_in_this_thread()) {
+
+			asio::post(*strand_,[this,r=ref(slot_),easy,c=std::move(c),p] () mutable {
+
+				CURLMsg msg{};
+				msg.easy_handle=easy;
+
+				auto l=r.lock();
+				if (!r) {
+
+					c(asio::error::operation_aborted,msg);
+					return;
+
+				}
+
+				try {
+
+					insert(easy,c,p);
+
+				} catch (...) {
+
+					c(to_error_code(std::current_exception()),msg);
+
+				}
+
+			});
+
+			return;
+
+		}
+
+		auto l=control_->lock();
+		insert(easy,c,p);
+
+	}
+
+
+	error_code io_service::to_error_code (std::exception_ptr ex) noexcept {
+
+		if (!ex) return error_code();
+
+		try {
+
+			std::rethrow_exception(std::move(ex));
+
+		} catch (const aborted &) {
+
+			return asio::error::operation_aborted;
+
+		} catch (const easy_error & e) {
+
+			return make_error_code(e.code());
+
+		} catch (const multi_error & e) {
+
+			return make_error_code(e.code());
+
+		} catch (const system_error & e) {
+
+			return e.code();
+
+		} catch (const std::bad_alloc &) {
+
+			return asio::error::no_memory;
+
+		//	The only logic error is an attempt to add an easy
+		//	handle which is already managed
+		} catch (const std::logic_error &) {
+
+			return asio::error::already_started;
+
+		} catch (...) {	}
+
+		return make_error_code(CURLM_INTERNAL_ERROR);
+
+	}
+
+
+	std::exception_ptr io_service::to_exception (error_code ec) noexcept {
+
+		if (ec==asio::error::operation_aborted) return make_exception(aborted{});
+		if (ec.category()==easy_category()) return make_exception(easy_error(static_cast<CURLcode>(ec.value())));
+		if (ec.category()==multi_category()) return make_exception(multi_error(static_cast<CURLMcode>(ec.value())));
+		if (ec==asio::error::already_started) return make_exception(std::logic_error("Attempt to add duplicate easy handle"));
+		if (ec==asio::error::no_memory) return make_exception(std::bad_alloc{});
+
+		return make_exception(system_error(ec));
+
+	}
+
+
+	io_service::completion io_service::promise_completion (promise<CURLMsg> p) {
+
+		return completion([p=std::move(p)] (error_code ec, const CURLMsg & msg) mutable {
+
+			if (ec) set_exception(p,to_exception(ec));
+			else p.set_value(msg);
+
+		});
+
+	}
+
+
+	future<CURLMsg> io_service::add (CURL * easy, priority level) {
+
+		promise<CURLMsg> p;
+		auto retr=p.get_future();
+
+		auto c=promise_completion(std::move(p));
+		start(easy,c,level);
+
+		return retr;
+
+	}
+
+
+	oneshot_future<CURLMsg> io_service::submit (CURL * easy, priority level) {
+
+		oneshot_promise<CURLMsg> p;
+		auto retr=p.get_future();
+
+		completion c([p=std::move(p)] (error_code ec, const CURLMsg & msg) mutable {
+
+			if (ec) p.set_exception(to_exception(ec));
+			else p.set_value(msg);
+
+		});
+		start(easy,c,level);
+
+		return retr;
+
+	}
+
+
+	void io_service::insert_batch (const std::vector<CURL *> & easies, std::vector<completion> & cs, std::vector<bool> & inserted, priority p) noexcept {
+
+		handles_.reserve(handles_.size()+easies.size());
+
+		batching_=true;
+		kick_=false;
+		for (std::size_t i=0;i<easies.size();++i) {
+
+			try {
+
+				insert(easies[i],cs[i],p);
+				inserted[i]=true;
+
+			} catch (...) {
+
+				CURLMsg msg{};
+				msg.easy_handle=easies[i];
+				cs[i](to_error_code(std::current_exception()),msg);
+
+			}
+
+		}
+		batching_=false;
+
+		try {
+
+			if (kick_) do_action(CURL_SOCKET_TIMEOUT,0);
+			schedule();
+
+		} catch (...) {
+
+			//	libcurl will never begin these transfers, but those
+			//	easy handles which were rejected (for example because
+			//	they were already managed by this io_service) belong
+			//	to other transfers which must be left alone
+			auto ec=to_error_code(std::current_exception());
+			for (std::size_t i=0;i<easies.size();++i) {
+
+				if (!inserted[i]) continue;
+				auto iter=handles_.find(easies[i]);
+				if (iter==handles_.end()) continue;
+				iter->second.fail(ec);
+				abort(iter);
+
+			}
+
+		}
+
+	}
+
+
+	std::vector<future<CURLMsg>> io_service::batch (std::vector<CURL *> easies, priority p) {
+
+		std::vector<future<CURLMsg>> retr;
+		retr.reserve(easies.size());
+		std::vector<completion> cs;
+		cs.reserve(easies.size());
+		std::vector<bool> inserted(easies.size(),false);
+		for (std::size_t i=0;i<easies.size();++i) {
+
+			promise<CURLMsg> p;
+			retr.push_back(p.get_future());
+			cs.push_back(promise_completion(std::move(p)));
+
+		}
+
+		if (strand_ && !strand_->running_in_this_thread()) {
+
+			asio::post(*strand_,[this,r=ref(slot_),easies=std::move(easies),cs=std::move(cs),inserted=std::move(inserted),p] () mutable {
+
+				auto l=r.lock();
+				if (!r) {
+
+					for (std::size_t i=0;i<easies.size();++i) {
+
+						CURLMsg msg{};
+						msg.easy_handle=easies[i];
+						cs[i](asio::error::operation_aborted,msg);
+
+					}
+
+					return;
+
+				}
+
+				insert_batch(easies,cs,inserted,p);
+
+			});
+
+			return retr;
+
+		}
+
+		auto l=control_->lock();
+		insert_batch(easies,cs,inserted,p);
+
+		return retr;
+
+	}
+
+
+	bool io_service::remove (CURL * easy) noexcept {
+
+		if (strand_ && !strand_->running_in_this_thread()) {
+
+			//	Posting allocates, if that fails the easy handle
+			//	remains in the io_service
+			try {
+
+				asio::post(*strand_,[this,r=ref(slot_),easy] () {
+
+					auto l=r.lock();
+					if (!r) return;
+					auto iter=handles_.find(easy);
+					if (iter!=handles_.end()) abort(iter);
+
+				});
+
+			} catch (...) {
+
+				return false;
+
+			}
+
+			return true;
+
+		}
+
+		auto l=control_->lock();
+
+		auto iter=handles_.find(easy);
+		if (iter==handles_.end()) return false;
+
+		abort(iter);
+		return true;
+
+	}
+
+
+	bool io_service::resume (CURL * easy) noexcept {
+
+		if (handles_.find(easy)==handles_.end()) return false;
+
+		auto result=curl_easy_pause(easy,CURLPAUSE_CONT);
+		if (result==CURLE_OK) return true;
+
+		//	libcurl may have completed the transfer from within
+		//	curl_easy_pause
+		auto iter=handles_.find(easy);
+		if (iter==handles_.end()) return true;
+		iter->second.fail(make_error_code(result));
+		abort(iter);
+
+		return true;
+
+	}
+
+
+	bool io_service::unpause (CURL * easy) noexcept {
+
+		if (strand_ && !strand_->running_in_this_thread()) {
+
+			//	As in remove
+			try {
+
+				asio::post(*strand_,[this,r=ref(slot_),easy] () {
+
+					auto l=r.lock();
+					if (r) resume(easy);
+
+				});
+
+			} catch (...) {
+
+				return false;
+
+			}
+
+			return true;
+
+		}
+
+		auto l=control_->lock();
+
+		return resume(easy);
+
+	}
+
+
+	void io_service::apply (const options & o) {
+
+		if (o.multiplex) multi_check(curl_multi_setopt(handle_,CURLMOPT_PIPELINING,*o.multiplex ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING));
+		if (o.max_host_connections) multi_check(curl_multi_setopt(handle_,CURLMOPT_MAX_HOST_CONNECTIONS,*o.max_host_connections));
+		if (o.max_total_connections) multi_check(curl_multi_setopt(handle_,CURLMOPT_MAX_TOTAL_CONNECTIONS,*o.max_total_connections));
+		if (o.max_connects) multi_check(curl_multi_setopt(handle_,CURLMOPT_MAXCONNECTS,*o.max_connects));
+		if (o.max_concurrent_streams) {
+
+			#if LIBCURL_VERSION_NUM>=0x074300
+			multi_check(curl_multi_setopt(handle_,CURLMOPT_MAX_CONCURRENT_STREAMS,*o.max_concurrent_streams));
+			#else
+			throw multi_error(CURLM_UNKNOWN_OPTION);
+			#endif
+
+		}
+		if (o.instrument) instrument_=*o.instrument;
+		if (o.batch_events) batch_events_=*o.batch_events;
+		if (o.max_in_flight) {
+
+			max_in_flight_=*o.max_in_flight;
+			promote();
+
+		}
+
+	}
+
+
+	void io_service::set_options (const options & o) {
+
+		//	Handlers hold this lock even when a strand is used
+		//	so the multi handle may be reconfigured from any thread
+		auto l=control_->lock();
+		apply(o);
+
+	}
+
+
+	std::size_t io_service::size () const noexcept {
+
+		return size_;
+
+	}
+
+
+	std::size_t io_service::queued () const noexcept {
+
+		return queued_;
+
+	}
+
+
+	metrics io_service::metrics () const {
+
+		asiocurl::metrics retr;
+		recorder_.snapshot(retr);
+
+		auto l=control_->lock();
+		retr.sockets=sockets_.size();
+		retr.handles=handles_.size();
+		retr.in_flight=in_flight_;
+		retr.queued=queued_;
+
+		return retr;
+
+	}
+
+
+	asio::io_service & io_service::get_io_service () const noexcept {
+
+		return ios_;
+
+	}
+
+
+	slab_pool & io_service::slabs () noexcept {
+
+		return slabs_;
 
 	}
 
@@ -0,0 +1,153 @@
+#include <asiocurl/asio.hpp>
+#include <asiocurl/future.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/io_service_pool.hpp>
+#include <asiocurl/metrics.hpp>
+#include <asiocurl/oneshot.hpp>
+#include <asiocurl/optional.hpp>
+#include <asiocurl/share.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+
+namespace asiocurl {
+
+
+	io_service_pool::shard::shard () : curl(ios), work(in_place,ios) {
+
+		start();
+
+	}
+
+
+	io_service_pool::shard::shard (share & sh) : curl(ios,sh), work(in_place,ios) {
+
+		start();
+
+	}
+
+
+	void io_service_pool::shard::start () {
+
+		thread=std::thread([this] () noexcept {	ios.run();	});
+
+	}
+
+
+	io_service_pool::shard::~shard () noexcept {
+
+		work=nullopt;
+		//	Pending asynchronous operations would otherwise keep
+		//	the thread alive indefinitely, the io_service destructor
+		//	takes care of them once the thread is gone
+		ios.stop();
+		thread.join();
+
+	}
+
+
+	io_service_pool::shard & io_service_pool::select () noexcept {
+
+		if (policy_==policy::round_robin) return *shards_[next_++%shards_.size()];
+
+		//	Start the search at a rotating offset so that ties
+		//	are not always broken in favour of the first shard
+		auto offset=next_++;
+		auto best=offset%shards_.size();
+		auto best_size=shards_[best]->curl.size();
+		for (std::size_t i=1;(i<shards_.size()) && (best_size!=0);++i) {
+
+			auto curr=(offset+i)%shards_.size();
+			auto curr_size=shards_[curr]->curl.size();
+			if (curr_size<best_size) {
+
+				best=curr;
+				best_size=curr_size;
+
+			}
+
+		}
+
+		return *shards_[best];
+
+	}
+
+
+	void io_service_pool::populate (std::size_t size, share * sh) {
+
+		if (size==0) throw std::invalid_argument("io_service_pool must have at least one shard");
+
+		shards_.reserve(size);
+		for (std::size_t i=0;i<size;++i) shards_.push_back(sh ? std::make_unique<shard>(*sh) : std::make_unique<shard>());
+
+	}
+
+
+	io_service_pool::io_service_pool (std::size_t size, policy p) : policy_(p), next_(0) {
+
+		populate(size,nullptr);
+
+	}
+
+
+	io_service_pool::io_service_pool (std::size_t size, share & sh, policy p) : policy_(p), next_(0) {
+
+		populate(size,&sh);
+
+	}
+
+
+	io_service_pool::~io_service_pool () noexcept {	}
+
+
+	future<CURLMsg> io_service_pool::add (CURL * easy) {
+
+		return select().curl.add(easy);
+
+	}
+
+
+	oneshot_future<CURLMsg> io_service_pool::submit (CURL * easy) {
+
+		return select().curl.submit(easy);
+
+	}
+
+
+	bool io_service_pool::remove (CURL * easy) noexcept {
+
+		for (auto && s : shards_) if (s->curl.remove(easy)) return true;
+
+		return false;
+
+	}
+
+
+	std::size_t io_service_pool::size () const noexcept {
+
+		return shards_.size();
+
+	}
+
+
+	metrics io_service_pool::metrics () const {
+
+		asiocurl::metrics retr;
+		for (auto && s : shards_) retr.merge(s->curl.metrics());
+
+		return retr;
+
+	}
+
+
+	io_service & io_service_pool::operator [] (std::size_t i) noexcept {
+
+		return shards_[i]->curl;
+
+	}
+
+
+}
@@ -0,0 +1,56 @@
+#include <asiocurl/metrics.hpp>
+
+
+namespace asiocurl {
+
+
+	metrics::metrics () noexcept
+		:	started(0),
+			completed(0),
+			aborted(0),
+			bytes_in(0),
+			bytes_out(0),
+			wakeups(0),
+			actions(0),
+			timer_updates(0),
+			timer_waits(0),
+			timer_posts(0),
+			reaps(0),
+			flushes(0),
+			sockets(0),
+			handles(0),
+			in_flight(0),
+			queued(0)
+	{	}
+
+
+	metrics & metrics::merge (const metrics & other) noexcept {
+
+		started+=other.started;
+		completed+=other.completed;
+		aborted+=other.aborted;
+		bytes_in+=other.bytes_in;
+		bytes_out+=other.bytes_out;
+		wakeups+=other.wakeups;
+		actions+=other.actions;
+		timer_updates+=other.timer_updates;
+		timer_waits+=other.timer_waits;
+		timer_posts+=other.timer_posts;
+		reaps+=other.reaps;
+		flushes+=other.flushes;
+		sockets+=other.sockets;
+		handles+=other.handles;
+		in_flight+=other.in_flight;
+		queued+=other.queued;
+		name_lookup.merge(other.name_lookup);
+		connect.merge(other.connect);
+		app_connect.merge(other.app_connect);
+		start_transfer.merge(other.start_transfer);
+		total.merge(other.total);
+
+		return *this;
+
+	}
+
+
+}
@@ -0,0 +1,168 @@
+#include <asiocurl/asio.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/response_sink.hpp>
+#include <asiocurl/slab_pool.hpp>
+#include <curl/curl.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+
+namespace asiocurl {
+
+
+	template <typename T>
+	static void setopt (CURL * easy, CURLoption option, T param) {
+
+		auto result=curl_easy_setopt(easy,option,param);
+		if (result!=CURLE_OK) throw easy_error(result);
+
+	}
+
+
+	std::size_t response_sink::write (char * ptr, std::size_t size, std::size_t nmemb, void * userdata) noexcept {
+
+		auto & self=*static_cast<response_sink *>(userdata);
+		auto n=size*nmemb;
+
+		try {
+
+			//	By the time the body begins to arrive libcurl has
+			//	parsed the headers
+			if (!self.started_) {
+
+				self.started_=true;
+				curl_off_t length;
+				if (
+					(curl_easy_getinfo(self.easy_,CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,&length)==CURLE_OK) &&
+					(length>0) &&
+					(static_cast<std::size_t>(length)<=self.max_reserve_)
+				) self.reserve(static_cast<std::size_t>(length));
+
+			}
+
+			self.append(ptr,n);
+
+		//	Causes libcurl to fail the transfer with
+		//	CURLE_WRITE_ERROR
+		} catch (...) {
+
+			return 0;
+
+		}
+
+		return n;
+
+	}
+
+
+	void response_sink::reserve (std::size_t length) {
+
+		auto slab=pool_->slab_size;
+		auto n=(length+slab-1)/slab;
+		chain_.reserve(n);
+		slabs_.reserve(n);
+		pool_->acquire(n,spare_);
+
+	}
+
+
+	void response_sink::append (const char * ptr, std::size_t n) {
+
+		auto slab=pool_->slab_size;
+		while (n!=0) {
+
+			if (chain_.empty() || (chain_.back().size()==slab)) {
+
+				if (spare_.empty()) pool_->acquire(1,spare_);
+				chain_.push_back(asio::const_buffer(spare_.back(),0));
+				try {
+
+					slabs_.push_back(spare_.back());
+
+				} catch (...) {
+
+					chain_.pop_back();
+					throw;
+
+				}
+				spare_.pop_back();
+
+			}
+
+			auto & back=chain_.back();
+			auto k=std::min(n,slab-back.size());
+			std::memcpy(slabs_.back()+back.size(),ptr,k);
+			back=asio::const_buffer(slabs_.back(),back.size()+k);
+			ptr+=k;
+			n-=k;
+			size_+=k;
+
+		}
+
+	}
+
+
+	response_sink::response_sink (slab_pool & pool, CURL * easy, std::size_t max_reserve)
+		:	pool_(pool.state_),
+			easy_(easy),
+			max_reserve_(max_reserve),
+			started_(false),
+			size_(0)
+	{
+
+		setopt(easy_,CURLOPT_WRITEFUNCTION,&write);
+		setopt(easy_,CURLOPT_WRITEDATA,static_cast<void *>(this));
+
+	}
+
+
+	response_sink::response_sink (io_service & curl, CURL * easy, std::size_t max_reserve) : response_sink(curl.slabs(),easy,max_reserve) {	}
+
+
+	response_sink::~response_sink () noexcept {
+
+		clear();
+
+	}
+
+
+	const response_sink::const_buffers_type & response_sink::data () const noexcept {
+
+		return chain_;
+
+	}
+
+
+	std::size_t response_sink::size () const noexcept {
+
+		return size_;
+
+	}
+
+
+	std::string response_sink::str () const {
+
+		std::string retr;
+		retr.reserve(size_);
+		for (auto && b : chain_) retr.append(static_cast<const char *>(b.data()),b.size());
+
+		return retr;
+
+	}
+
+
+	void response_sink::clear () noexcept {
+
+		pool_->release(slabs_);
+		pool_->release(spare_);
+		chain_.clear();
+		size_=0;
+		started_=false;
+
+	}
+
+
+}
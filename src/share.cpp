@@ -0,0 +1,93 @@
+#include <asiocurl/exception.hpp>
+#include <asiocurl/scope.hpp>
+#include <asiocurl/share.hpp>
+#include <curl/curl.h>
+#include <initializer_list>
+
+
+namespace asiocurl {
+
+
+	template <typename T>
+	static void share_check (CURLSH * handle, CURLSHoption option, T param) {
+
+		auto result=curl_share_setopt(handle,option,param);
+		if (result!=CURLSHE_OK) throw share_error(result);
+
+	}
+
+
+	void share::lock_function (CURL *, curl_lock_data data, curl_lock_access access, void * userptr) noexcept {
+
+		auto & l=static_cast<share *>(userptr)->locks_[data];
+		if (access==CURL_LOCK_ACCESS_SHARED) {
+
+			l.m.lock_shared();
+			return;
+
+		}
+
+		l.m.lock();
+		l.exclusive=true;
+
+	}
+
+
+	void share::unlock_function (CURL *, curl_lock_data data, void * userptr) noexcept {
+
+		//	libcurl does not say which kind of access is being
+		//	relinquished
+		auto & l=static_cast<share *>(userptr)->locks_[data];
+		if (l.exclusive) {
+
+			l.exclusive=false;
+			l.m.unlock();
+			return;
+
+		}
+
+		l.m.unlock_shared();
+
+	}
+
+
+	share::share () : share({CURL_LOCK_DATA_DNS,CURL_LOCK_DATA_SSL_SESSION}) {	}
+
+
+	share::share (std::initializer_list<curl_lock_data> data) : handle_(curl_share_init()) {
+
+		if (!handle_) throw error("curl_share_init failed");
+		auto g=make_scope_exit([&] () noexcept {	curl_share_cleanup(handle_);	});
+
+		share_check(handle_,CURLSHOPT_LOCKFUNC,&lock_function);
+		share_check(handle_,CURLSHOPT_UNLOCKFUNC,&unlock_function);
+		share_check(handle_,CURLSHOPT_USERDATA,static_cast<void *>(this));
+		for (auto d : data) share_check(handle_,CURLSHOPT_SHARE,d);
+
+		g.release();
+
+	}
+
+
+	share::~share () noexcept {
+
+		curl_share_cleanup(handle_);
+
+	}
+
+
+	share::native_handle_type share::native_handle () const noexcept {
+
+		return handle_;
+
+	}
+
+
+	share::operator native_handle_type () const noexcept {
+
+		return handle_;
+
+	}
+
+
+}
@@ -0,0 +1,89 @@
+#include <asiocurl/slab_pool.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace asiocurl {
+
+
+	slab_pool::state::state (std::size_t size, std::size_t max) : slab_size(size), max_idle(max) {	}
+
+
+	slab_pool::state::~state () noexcept {
+
+		for (auto slab : idle) delete[] slab;
+
+	}
+
+
+	void slab_pool::state::acquire (std::size_t n, std::vector<char *> & out) {
+
+		out.reserve(out.size()+n);
+		{
+
+			std::lock_guard<std::mutex> l(m);
+			for (;(n!=0) && !idle.empty();--n) {
+
+				out.push_back(idle.back());
+				idle.pop_back();
+
+			}
+
+		}
+		for (;n!=0;--n) out.push_back(new char[slab_size]);
+
+	}
+
+
+	void slab_pool::state::release (std::vector<char *> & in) noexcept {
+
+		{
+
+			std::lock_guard<std::mutex> l(m);
+			while (!in.empty() && (idle.size()<max_idle)) {
+
+				//	Until the vector's capacity reaches max_idle any
+				//	push_back may reallocate and fail, in which case
+				//	this slab and those after it are freed below
+				try {
+
+					idle.push_back(in.back());
+
+				} catch (...) {
+
+					break;
+
+				}
+				in.pop_back();
+
+			}
+
+		}
+		for (auto slab : in) delete[] slab;
+		in.clear();
+
+	}
+
+
+	slab_pool::slab_pool (std::size_t slab_size, std::size_t max_idle) : state_(std::make_shared<state>(slab_size,max_idle)) {	}
+
+
+	std::size_t slab_pool::slab_size () const noexcept {
+
+		return state_->slab_size;
+
+	}
+
+
+	std::size_t slab_pool::idle () const noexcept {
+
+		std::lock_guard<std::mutex> l(state_->m);
+
+		return state_->idle.size();
+
+	}
+
+
+}
@@ -0,0 +1,67 @@
+#include "allocations.hpp"
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+static thread_local bool counting=false;
+static thread_local std::size_t allocations=0;
+
+
+void start_counting_allocations () noexcept {
+
+	allocations=0;
+	counting=true;
+
+}
+
+
+std::size_t stop_counting_allocations () noexcept {
+
+	counting=false;
+
+	return allocations;
+
+}
+
+
+void * operator new (std::size_t size) {
+
+	if (counting) ++allocations;
+	if (size==0) size=1;
+	if (auto retr=std::malloc(size)) return retr;
+	throw std::bad_alloc{};
+
+}
+
+
+void * operator new (std::size_t size, const std::nothrow_t &) noexcept {
+
+	if (counting) ++allocations;
+	if (size==0) size=1;
+	return std::malloc(size);
+
+}
+
+
+void operator delete (void * ptr) noexcept {
+
+	std::free(ptr);
+
+}
+
+
+void operator delete (void * ptr, std::size_t) noexcept {
+
+	std::free(ptr);
+
+}
+
+
+void operator delete (void * ptr, const std::nothrow_t &) noexcept {
+
+	std::free(ptr);
+
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+
+#include <cstddef>
+
+
+//	Begins counting the allocations made through the global
+//	operator new by the calling thread
+void start_counting_allocations () noexcept;
+//	Stops counting the allocations made by the calling thread
+//	and returns the number counted since counting began
+std::size_t stop_counting_allocations () noexcept;
@@ -0,0 +1,192 @@
+#include <asiocurl/body_stream.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+
+
+namespace {
+
+
+	//	Reads until a read fails, recording everything which was
+	//	read, how many reads there were, and the error
+	class reader {
+
+
+		private:
+
+
+			asiocurl::body_stream & stream_;
+			std::vector<char> buffer_;
+			std::function<void (asiocurl::error_code, std::size_t)> f_;
+
+
+		public:
+
+
+			std::string body;
+			std::size_t reads;
+			asiocurl::error_code ec;
+
+
+			reader (asiocurl::body_stream & stream, std::size_t size) : stream_(stream), buffer_(size), reads(0) {
+
+				f_=[this] (auto ec, auto n) {
+
+					body.append(buffer_.data(),n);
+					if (ec) {
+
+						this->ec=ec;
+						return;
+
+					}
+					++reads;
+					read();
+
+				};
+
+			}
+
+
+			void read () {
+
+				stream_.async_read_some(asiocurl::asio::buffer(buffer_),f_);
+
+			}
+
+
+	};
+
+
+}
+
+
+SCENARIO("asiocurl::body_stream objects expose response bodies as asynchronous streams","[asiocurl][body_stream]") {
+
+	GIVEN("An asiocurl::io_service and an easy handle which will receive a large body") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		std::size_t size=4*1024*1024;
+		streamer server(size);
+		asiocurl::easy easy;
+		set_url(easy,server.url());
+
+		WHEN("The body is read through an asiocurl::body_stream") {
+
+			asiocurl::body_stream stream(curl,easy);
+			reader r(stream,64*1024);
+			r.read();
+			ios.run();
+
+			THEN("The entire body is read") {
+
+				CHECK(r.body.size()==size);
+				CHECK(r.body.find_first_not_of('x')==std::string::npos);
+
+			}
+
+			THEN("The final read fails with end of file") {
+
+				CHECK(r.ec==asiocurl::asio::error::eof);
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::io_service and an easy handle which will receive a small body") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		streamer server(100);
+		asiocurl::easy easy;
+		set_url(easy,server.url());
+
+		WHEN("The body is read through an asiocurl::body_stream one byte at a time") {
+
+			asiocurl::body_stream stream(curl,easy);
+			reader r(stream,1);
+			r.read();
+			ios.run();
+
+			THEN("Each read yields one byte") {
+
+				CHECK(r.body==std::string(100,'x'));
+				CHECK(r.reads==100);
+				CHECK(r.ec==asiocurl::asio::error::eof);
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::io_service and an easy handle which represents a transfer which will fail") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		asiocurl::easy easy;
+		set_url(easy,"http://127.0.0.1:1/");
+
+		WHEN("The body is read through an asiocurl::body_stream") {
+
+			asiocurl::body_stream stream(curl,easy);
+			reader r(stream,16);
+			r.read();
+			ios.run();
+
+			THEN("The read fails with the error which caused the transfer to fail") {
+
+				CHECK(r.body.empty());
+				CHECK(r.ec==asiocurl::make_error_code(CURLE_COULDNT_CONNECT));
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::io_service and an easy handle which represents a transfer which will never complete") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		blackhole b;
+		asiocurl::easy easy;
+		set_url(easy,b.url());
+
+		WHEN("A read is started and the asiocurl::body_stream is destroyed") {
+
+			asiocurl::error_code ec;
+			std::vector<char> buffer(16);
+			{
+
+				asiocurl::body_stream stream(curl,easy);
+				stream.async_read_some(asiocurl::asio::buffer(buffer),[&] (auto e, auto) {	ec=e;	});
+
+			}
+			ios.run();
+
+			THEN("The read is aborted") {
+
+				CHECK(ec==asiocurl::asio::error::operation_aborted);
+				CHECK(curl.size()==0);
+
+			}
+
+		}
+
+	}
+
+}
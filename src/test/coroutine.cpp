@@ -0,0 +1,247 @@
+#include <asiocurl/io_service.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/exception.hpp>
+#include <curl/curl.h>
+#include <exception>
+#include <stdexcept>
+#include <catch.hpp>
+
+
+//	This file is compiled as C++20 when the compiler supports it
+//	(see CMakeLists.txt) and is otherwise empty
+
+
+#ifdef ASIOCURL_HAS_COROUTINES
+
+
+namespace {
+
+
+	//	A coroutine which begins executing immediately and whose
+	//	state is destroyed when it finishes
+	class task {
+
+
+		public:
+
+
+			class promise_type {
+
+
+				public:
+
+
+					task get_return_object () noexcept {
+
+						return task{};
+
+					}
+
+
+					std::suspend_never initial_suspend () noexcept {
+
+						return {};
+
+					}
+
+
+					std::suspend_never final_suspend () noexcept {
+
+						return {};
+
+					}
+
+
+					void return_void () noexcept {	}
+
+
+					void unhandled_exception () noexcept {
+
+						std::terminate();
+
+					}
+
+
+			};
+
+
+	};
+
+
+	//	What a coroutine which awaits a transfer observed
+	class outcome {
+
+
+		public:
+
+
+			bool suspended;
+			bool resumed;
+			bool running;
+			bool aborted;
+			CURLMsg msg;
+
+
+			outcome () noexcept : suspended(false), resumed(false), running(false), aborted(false), msg{} {	}
+
+
+	};
+
+
+	task perform (asiocurl::asio::io_service & ios, asiocurl::io_service & curl, CURL * easy, outcome & o) {
+
+		o.suspended=true;
+		try {
+
+			o.msg=co_await curl.perform(easy);
+
+		} catch (const asiocurl::aborted &) {
+
+			o.aborted=true;
+
+		}
+		o.resumed=true;
+		o.running=ios.get_executor().running_in_this_thread();
+
+	}
+
+
+}
+
+
+SCENARIO("asiocurl::io_service::perform may be awaited by a C++20 coroutine","[asiocurl][io_service][coroutine]") {
+
+	GIVEN("An asiocurl::io_service and a curl easy handle which represents a transfer") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		streamer server(1024);
+		asiocurl::easy easy;
+		set_url(easy,server.url());
+
+		WHEN("A coroutine awaits the transfer") {
+
+			outcome o;
+			perform(ios,curl,easy,o);
+
+			THEN("The coroutine is suspended until the transfer completes") {
+
+				CHECK(o.suspended);
+				CHECK_FALSE(o.resumed);
+				CHECK(curl.size()==1);
+
+				AND_WHEN("asiocurl::asio::io_service::run is invoked") {
+
+					ios.run();
+
+					THEN("The coroutine is resumed by the thread which completes the transfer") {
+
+						REQUIRE(o.resumed);
+						CHECK(o.running);
+
+					}
+
+					THEN("The co_await expression yields the result of the transfer") {
+
+						CHECK_FALSE(o.aborted);
+						CHECK(o.msg.easy_handle==easy.native_handle());
+						CHECK(o.msg.data.result==CURLE_OK);
+						CHECK(curl.size()==0);
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::io_service and a curl easy handle which represents a transfer which never completes") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		blackhole b;
+		asiocurl::easy easy;
+		set_url(easy,b.url());
+
+		WHEN("A coroutine awaits the transfer and it is removed") {
+
+			outcome o;
+			perform(ios,curl,easy,o);
+			REQUIRE(curl.remove(easy));
+
+			THEN("The coroutine is not resumed from within asiocurl::io_service::remove") {
+
+				CHECK_FALSE(o.resumed);
+
+				AND_WHEN("asiocurl::asio::io_service::run is invoked") {
+
+					ios.run();
+
+					THEN("The co_await expression throws asiocurl::aborted") {
+
+						REQUIRE(o.resumed);
+						CHECK(o.aborted);
+						CHECK(o.running);
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+
+	GIVEN("A curl easy handle which is already managed by an asiocurl::io_service") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		blackhole b;
+		asiocurl::easy easy;
+		set_url(easy,b.url());
+		curl.add(easy);
+
+		WHEN("A coroutine awaits a transfer of it") {
+
+			bool thrown=false;
+			bool finished=false;
+			[&] () -> task {
+
+				try {
+
+					co_await curl.perform(easy);
+
+				} catch (const std::logic_error &) {
+
+					thrown=true;
+
+				}
+				finished=true;
+
+			}();
+
+			THEN("The coroutine is not suspended and the co_await expression throws") {
+
+				CHECK(finished);
+				CHECK(thrown);
+
+			}
+
+		}
+
+		curl.remove(easy);
+
+	}
+
+}
+
+
+#endif
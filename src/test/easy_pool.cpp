@@ -0,0 +1,218 @@
+#include <asiocurl/easy_pool.hpp>
+
+
+#include <asiocurl/easy.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <catch.hpp>
+
+
+namespace {
+
+
+	char tag;
+
+
+	void * get_private (CURL * easy) {
+
+		char * retr=nullptr;
+		REQUIRE(curl_easy_getinfo(easy,CURLINFO_PRIVATE,&retr)==CURLE_OK);
+
+		return retr;
+
+	}
+
+
+	void set_private (CURL * easy) {
+
+		REQUIRE(curl_easy_setopt(easy,CURLOPT_PRIVATE,&tag)==CURLE_OK);
+
+	}
+
+
+}
+
+
+SCENARIO("asiocurl::easy_pool objects reuse easy handles","[asiocurl][easy_pool]") {
+
+	GIVEN("An asiocurl::easy_pool which retains one idle easy handle") {
+
+		asiocurl::easy_pool pool(1);
+
+		THEN("There are no idle easy handles") {
+
+			CHECK(pool.idle()==0);
+
+		}
+
+		WHEN("An easy handle is acquired, configured, and returned") {
+
+			CURL * native;
+			{
+
+				auto h=pool.acquire();
+				native=h;
+				REQUIRE(native);
+				set_private(h);
+
+			}
+
+			THEN("It is idle") {
+
+				CHECK(pool.idle()==1);
+
+			}
+
+			AND_WHEN("An easy handle is acquired") {
+
+				auto h=pool.acquire();
+
+				THEN("It is the same easy handle") {
+
+					CHECK(static_cast<CURL *>(h)==native);
+					CHECK(pool.idle()==0);
+
+				}
+
+				THEN("Its options have been reset") {
+
+					CHECK(get_private(h)==nullptr);
+
+				}
+
+			}
+
+		}
+
+		WHEN("Two easy handles are acquired and returned") {
+
+			{
+
+				auto a=pool.acquire();
+				auto b=pool.acquire();
+				CHECK(static_cast<CURL *>(a)!=static_cast<CURL *>(b));
+
+			}
+
+			THEN("Only one of them is retained") {
+
+				CHECK(pool.idle()==1);
+
+			}
+
+		}
+
+		WHEN("An acquired easy handle is moved") {
+
+			auto a=pool.acquire();
+			CURL * native=a;
+			auto b=std::move(a);
+
+			THEN("It is only returned once") {
+
+				{	auto moved=std::move(b);	}
+				CHECK(pool.idle()==1);
+				auto c=pool.acquire();
+				CHECK(static_cast<CURL *>(c)==native);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::easy_pool objects initialize the easy handles they hand out","[asiocurl][easy_pool]") {
+
+	GIVEN("An asiocurl::easy_pool with an initializer") {
+
+		asiocurl::easy_pool pool(1,[] (asiocurl::easy & e) {	set_private(e);	});
+
+		WHEN("An easy handle is acquired") {
+
+			auto h=pool.acquire();
+
+			THEN("It has been initialized") {
+
+				CHECK(get_private(h)==&tag);
+
+			}
+
+		}
+
+		WHEN("An easy handle is returned and acquired again") {
+
+			{
+
+				auto h=pool.acquire();
+				REQUIRE(curl_easy_setopt(h,CURLOPT_PRIVATE,nullptr)==CURLE_OK);
+
+			}
+			auto h=pool.acquire();
+
+			THEN("It has been reset and initialized again") {
+
+				CHECK(get_private(h)==&tag);
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::easy_pool with a prototype") {
+
+		asiocurl::easy prototype;
+		set_private(prototype);
+		asiocurl::easy_pool pool(prototype,1);
+
+		WHEN("An easy handle is acquired") {
+
+			auto h=pool.acquire();
+
+			THEN("It is a duplicate of the prototype") {
+
+				CHECK(static_cast<CURL *>(h)!=prototype.native_handle());
+				CHECK(get_private(h)==&tag);
+
+			}
+
+		}
+
+		WHEN("Easy handles are acquired by several threads at once") {
+
+			//	Nothing is retained so that every easy handle is
+			//	duplicated, and Catch's assertions may not be used from
+			//	other threads
+			asiocurl::easy_pool unretained(prototype,0);
+			std::vector<std::size_t> duplicates(4,0);
+			std::vector<std::thread> ts;
+			for (auto && d : duplicates) ts.emplace_back([&unretained,&d] () noexcept {
+
+				for (std::size_t i=0;i<100;++i) {
+
+					auto h=unretained.acquire();
+					char * ptr=nullptr;
+					if ((curl_easy_getinfo(h,CURLINFO_PRIVATE,&ptr)==CURLE_OK) && (ptr==&tag)) ++d;
+
+				}
+
+			});
+			for (auto && t : ts) t.join();
+
+			THEN("Each is a duplicate of the prototype") {
+
+				for (auto d : duplicates) CHECK(d==100);
+
+			}
+
+		}
+
+	}
+
+}
@@ -0,0 +1,129 @@
+#include <asiocurl/histogram.hpp>
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <catch.hpp>
+
+
+SCENARIO("asiocurl::histogram buckets durations with a bounded relative error","[asiocurl][histogram]") {
+
+	GIVEN("asiocurl::histogram::bucket and asiocurl::histogram::upper_bound") {
+
+		THEN("Short durations each have their own bucket") {
+
+			for (std::uint64_t us=0;us<32;++us) {
+
+				CHECK(asiocurl::histogram::bucket(us)==us);
+				CHECK(asiocurl::histogram::upper_bound(us)==us);
+
+			}
+
+		}
+
+		THEN("Every bucket's upper bound falls into that bucket and the next duration into the next bucket") {
+
+			for (std::size_t i=0;i<(asiocurl::histogram::buckets-1);++i) {
+
+				auto upper=asiocurl::histogram::upper_bound(i);
+				CHECK(asiocurl::histogram::bucket(upper)==i);
+				CHECK(asiocurl::histogram::bucket(upper+1)==(i+1));
+
+			}
+
+		}
+
+		THEN("Extremely long durations fall into the last bucket") {
+
+			CHECK(asiocurl::histogram::bucket(~std::uint64_t(0))==(asiocurl::histogram::buckets-1));
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::histogram reports percentiles","[asiocurl][histogram]") {
+
+	GIVEN("An empty asiocurl::histogram") {
+
+		asiocurl::histogram h;
+
+		THEN("It is empty") {
+
+			CHECK(h.count()==0);
+			CHECK(h.max().count()==0);
+			CHECK(h.percentile(0.5).count()==0);
+
+		}
+
+		WHEN("The durations from 1 to 1000 microseconds are recorded") {
+
+			for (int i=1;i<=1000;++i) h.record(std::chrono::microseconds(i));
+
+			THEN("The count and maximum are exact") {
+
+				CHECK(h.count()==1000);
+				CHECK(h.max()==std::chrono::microseconds(1000));
+				CHECK(h.percentile(1)==std::chrono::microseconds(1000));
+
+			}
+
+			THEN("Percentiles are within the relative error of the histogram") {
+
+				auto p50=h.percentile(0.5).count();
+				CHECK(p50>=500);
+				CHECK(p50<=532);
+				auto p99=h.percentile(0.99).count();
+				CHECK(p99>=990);
+				CHECK(p99<=1000);
+
+			}
+
+			AND_WHEN("Another histogram is merged into it") {
+
+				asiocurl::histogram other;
+				other.record(std::chrono::microseconds(5000));
+				h.merge(other);
+
+				THEN("The durations of both are reported") {
+
+					CHECK(h.count()==1001);
+					CHECK(h.max()==std::chrono::microseconds(5000));
+
+				}
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::atomic_histogram") {
+
+		asiocurl::atomic_histogram h;
+
+		WHEN("Durations are recorded and a snapshot taken") {
+
+			h.record(std::chrono::microseconds(3));
+			h.record(std::chrono::microseconds(100));
+			h.record(std::chrono::microseconds(-1));
+			auto s=h.snapshot();
+
+			THEN("The snapshot contains those durations") {
+
+				CHECK(s.count()==3);
+				CHECK(s.count(0)==1);
+				CHECK(s.count(3)==1);
+				CHECK(s.count(asiocurl::histogram::bucket(100))==1);
+				CHECK(s.max()==std::chrono::microseconds(100));
+
+			}
+
+		}
+
+	}
+
+}
@@ -1,16 +1,31 @@
 #include <asiocurl/io_service.hpp>
 
 
+#include "allocations.hpp"
+#include "servers.hpp"
 #include <asiocurl/asio.hpp>
 #include <asiocurl/easy.hpp>
+#include <asiocurl/error.hpp>
 #include <asiocurl/exception.hpp>
+#include <asiocurl/oneshot.hpp>
 #include <asiocurl/optional.hpp>
+#include <asiocurl/scope.hpp>
+#include <asiocurl/transfer_stats.hpp>
 #include <curl/curl.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 #include <catch.hpp>
+#ifdef ASIOCURL_USE_BOOST_ASIO
+#include <boost/asio/spawn.hpp>
+#endif
 
 
 namespace {
@@ -95,6 +110,59 @@ namespace {
 	};
 
 
+	//	Counts the allocations made on the thread which runs the
+	//	asiocurl::asio::io_service between the first and last
+	//	invocations of the write callback it observes, by which time
+	//	the transfer has reached a steady state
+	class allocation_counter {
+
+
+		private:
+
+
+			std::size_t calls_;
+			std::size_t first_;
+			std::size_t last_;
+
+
+		public:
+
+
+			std::size_t allocations;
+
+
+			allocation_counter (std::size_t first, std::size_t last) noexcept : calls_(0), first_(first), last_(last), allocations(0) {	}
+
+
+			static std::size_t write (char *, std::size_t size, std::size_t nmemb, void * userdata) noexcept {
+
+				auto & self=*static_cast<allocation_counter *>(userdata);
+				auto call=self.calls_++;
+				if (call==self.first_) {
+
+					start_counting_allocations();
+
+				} else if (call==self.last_) {
+
+					self.allocations=stop_counting_allocations();
+
+				}
+
+				return size*nmemb;
+
+			}
+
+
+			bool complete () const noexcept {
+
+				return calls_>last_;
+
+			}
+
+
+	};
+
+
 }
 
 
@@ -127,6 +195,13 @@ static void set (asiocurl::easy::native_handle_type easy, CURLoption option, T p
 }
 
 
+static std::size_t discard (char *, std::size_t size, std::size_t nmemb, void *) noexcept {
+
+	return size*nmemb;
+
+}
+
+
 SCENARIO_METHOD(fixture,"asiocurl::io_service::add rejects duplicate easy handles","[asiocurl][io_service]") {
 
 	GIVEN("A curl easy handle") {
@@ -188,6 +263,230 @@ SCENARIO_METHOD(fixture,"asiocurl::io_service::remove may be used to abort trans
 
 	}
 
+	GIVEN("Many transfers which never complete and which are in flight") {
+
+		blackhole b;
+		std::vector<asiocurl::easy> easies(64);
+		std::size_t invoked=0;
+		std::size_t aborted=0;
+		for (auto && easy : easies) {
+
+			set(easy,CURLOPT_URL,b.url().c_str());
+			curl.async_perform(easy,[&] (auto ec, auto) {
+
+				++invoked;
+				if (ec==asiocurl::asio::error::operation_aborted) ++aborted;
+
+			});
+
+		}
+		ios.poll();
+		ios.restart();
+
+		WHEN("They are all removed and asiocurl::asio::io_service::run is invoked") {
+
+			std::size_t removed=0;
+			for (auto && easy : easies) if (curl.remove(easy)) ++removed;
+			ios.run();
+
+			THEN("Every completion handler is invoked once with asiocurl::asio::error::operation_aborted") {
+
+				CHECK(removed==easies.size());
+				CHECK(invoked==easies.size());
+				CHECK(aborted==easies.size());
+				CHECK(curl.size()==0);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO_METHOD(fixture,"asiocurl::io_service::submit reports the completion of transfers through an asiocurl::oneshot_future","[asiocurl][io_service]") {
+
+	GIVEN("A curl easy handle") {
+
+		asiocurl::easy easy;
+
+		WHEN("It is passed to asiocurl::io_service::submit and a continuation is attached to the result") {
+
+			bool aborted=false;
+			curl.submit(easy).then([&] (asiocurl::oneshot_future<CURLMsg> f) noexcept {
+
+				try {
+
+					f.get();
+
+				} catch (const asiocurl::aborted &) {
+
+					aborted=true;
+
+				} catch (...) {	}
+
+			});
+
+			AND_WHEN("It is removed") {
+
+				REQUIRE(curl.remove(easy));
+
+				THEN("The continuation is invoked with the aborted transfer") {
+
+					CHECK(aborted);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO_METHOD(fixture,"asiocurl::io_service::submit invokes a continuation passed with the easy handle","[asiocurl][io_service]") {
+
+	GIVEN("A curl easy handle which represents a transfer") {
+
+		streamer server(16);
+		asiocurl::easy easy;
+		set_url(easy,server.url());
+		bool invoked=false;
+		bool aborted=false;
+		CURLMsg msg{};
+		auto continuation=[&] (asiocurl::oneshot_future<CURLMsg> f) noexcept {
+
+			invoked=true;
+			try {
+
+				msg=f.get();
+
+			} catch (const asiocurl::aborted &) {
+
+				aborted=true;
+
+			} catch (...) {	}
+
+		};
+
+		WHEN("It is passed to asiocurl::io_service::submit with a continuation") {
+
+			curl.submit(easy,continuation);
+
+			THEN("The continuation is not invoked") {
+
+				CHECK_FALSE(invoked);
+
+			}
+
+			AND_WHEN("asiocurl::asio::io_service::run is invoked") {
+
+				ios.run();
+
+				THEN("The continuation is invoked with the result of the transfer") {
+
+					REQUIRE(invoked);
+					CHECK_FALSE(aborted);
+					CHECK(msg.easy_handle==easy.native_handle());
+					CHECK(msg.data.result==CURLE_OK);
+
+				}
+
+			}
+
+			AND_WHEN("It is removed") {
+
+				REQUIRE(curl.remove(easy));
+
+				THEN("The continuation is invoked with the aborted transfer") {
+
+					CHECK(invoked);
+					CHECK(aborted);
+
+				}
+
+			}
+
+		}
+
+		//	The easy handle must not be destroyed while the
+		//	asiocurl::io_service still manages it
+		curl.remove(easy);
+
+	}
+
+}
+
+
+SCENARIO_METHOD(fixture,"asiocurl::io_service::add_batch adds several easy handles at once","[asiocurl][io_service]") {
+
+	GIVEN("Several curl easy handles which represent transfers which will not complete") {
+
+		blackhole b;
+		auto u=b.url();
+		std::vector<asiocurl::easy> easies(3);
+		for (auto && easy : easies) set(easy,CURLOPT_URL,u.c_str());
+		//	The easy handles must not be destroyed while the
+		//	asiocurl::io_service still manages them
+		auto g=asiocurl::make_scope_exit([&] () noexcept {	for (auto && easy : easies) curl.remove(easy);	});
+
+		WHEN("They are passed to asiocurl::io_service::add_batch") {
+
+			auto fs=curl.add_batch(easies);
+
+			THEN("A future is returned for each easy handle") {
+
+				CHECK(fs.size()==easies.size());
+
+			}
+
+			THEN("Each easy handle is managed by the asiocurl::io_service") {
+
+				CHECK(curl.size()==easies.size());
+
+			}
+
+			AND_WHEN("They are removed") {
+
+				for (auto && easy : easies) REQUIRE(curl.remove(easy));
+
+				THEN("Each transfer is aborted") {
+
+					for (auto && f : fs) CHECK_THROWS_AS(f.get(),asiocurl::aborted);
+
+				}
+
+			}
+
+		}
+
+		WHEN("They are passed to asiocurl::io_service::add_batch along with a duplicate") {
+
+			std::vector<CURL *> handles;
+			for (auto && easy : easies) handles.push_back(easy);
+			handles.push_back(easies.front());
+			auto fs=curl.add_batch(handles);
+
+			THEN("The duplicate fails through its future") {
+
+				REQUIRE(fs.size()==handles.size());
+				CHECK_THROWS_AS(fs.back().get(),std::logic_error);
+
+			}
+
+			THEN("The other easy handles are managed by the asiocurl::io_service") {
+
+				CHECK(curl.size()==easies.size());
+
+			}
+
+		}
+
+	}
+
 }
 
 
@@ -328,3 +627,843 @@ SCENARIO_METHOD(fixture,"Transfers managed by an asiocurl::io_service object com
 	}
 
 }
+
+
+SCENARIO("asiocurl::io_service objects which use a strand perform asiocurl::io_service::add and asiocurl::io_service::remove on that strand","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service which uses a strand and a curl easy handle") {
+
+		asiocurl::easy easy;
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios,asiocurl::io_service::serialization::strand);
+
+		WHEN("It is added to the asiocurl::io_service twice") {
+
+			auto a=curl.add(easy);
+			auto b=curl.add(easy);
+
+			THEN("Neither addition takes effect until the strand runs") {
+
+				CHECK(curl.size()==0);
+
+				AND_WHEN("The strand runs") {
+
+					ios.poll();
+
+					THEN("The second addition fails through the returned future") {
+
+						CHECK_THROWS_AS(b.get(),std::logic_error);
+
+					}
+
+				}
+
+			}
+
+			AND_WHEN("It is removed from the asiocurl::io_service") {
+
+				CHECK(curl.remove(easy));
+
+				AND_WHEN("The strand runs") {
+
+					ios.poll();
+
+					THEN("The transfer is aborted") {
+
+						CHECK_THROWS_AS(a.get(),asiocurl::aborted);
+
+					}
+
+				}
+
+			}
+
+		}
+
+	}
+	GIVEN("An asiocurl::io_service which uses a strand and which is run by several threads") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios,asiocurl::io_service::serialization::strand);
+		std::vector<std::unique_ptr<runner>> runners;
+		for (std::size_t i=0;i<4;++i) runners.push_back(std::make_unique<runner>(ios));
+		auto g=asiocurl::make_scope_exit([&] () noexcept {	ios.stop();	});
+
+		WHEN("Transfers are added and removed from other threads") {
+
+			//	The callbacks of transfers are only ever invoked from
+			//	within the strand, so they never overlap
+			std::atomic<bool> inside(false);
+			std::atomic<bool> overlapped(false);
+			auto write=[] (char *, std::size_t size, std::size_t nmemb, void * userdata) noexcept -> std::size_t {
+
+				auto & pair=*static_cast<std::pair<std::atomic<bool> *,std::atomic<bool> *> *>(userdata);
+				if (pair.first->exchange(true)) pair.second->store(true);
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+				pair.first->store(false);
+
+				return size*nmemb;
+
+			};
+			std::pair<std::atomic<bool> *,std::atomic<bool> *> flags(&inside,&overlapped);
+			std::vector<std::unique_ptr<streamer>> servers;
+			std::vector<asiocurl::easy> easies(8);
+			for (auto && easy : easies) {
+
+				servers.push_back(std::make_unique<streamer>(256*1024));
+				set_url(easy,servers.back()->url());
+				set(easy,CURLOPT_WRITEFUNCTION,static_cast<std::size_t (*) (char *, std::size_t, std::size_t, void *)>(write));
+				set(easy,CURLOPT_WRITEDATA,static_cast<void *>(&flags));
+
+			}
+			blackhole b;
+			std::vector<asiocurl::easy> removed(8);
+			for (auto && easy : removed) set_url(easy,b.url());
+
+			std::vector<asiocurl::future<CURLMsg>> fs;
+			for (auto && easy : easies) fs.push_back(curl.add(easy));
+			std::vector<asiocurl::future<CURLMsg>> rs;
+			for (auto && easy : removed) rs.push_back(curl.add(easy));
+			std::size_t scheduled=0;
+			for (auto && easy : removed) if (curl.remove(easy)) ++scheduled;
+			//	The easy handles are in use until their results are
+			//	ready, whether or not they were removed
+			std::size_t succeeded=0;
+			for (auto && f : fs) if (f.get().data.result==CURLE_OK) ++succeeded;
+			std::size_t aborted=0;
+			for (auto && f : rs) try {
+
+				f.get();
+
+			} catch (const asiocurl::aborted &) {
+
+				++aborted;
+
+			}
+
+			THEN("The transfers which were not removed complete successfully") {
+
+				CHECK(succeeded==easies.size());
+
+			}
+
+			THEN("The callbacks of the transfers never run concurrently") {
+
+				CHECK_FALSE(overlapped);
+
+			}
+
+			THEN("The transfers which were removed are aborted") {
+
+				CHECK(scheduled==removed.size());
+				CHECK(aborted==removed.size());
+
+			}
+
+		}
+
+	}
+
+}
+
+
+static long primary_port (CURL * easy) {
+
+	long retr=0;
+	auto result=curl_easy_getinfo(easy,CURLINFO_PRIMARY_PORT,&retr);
+	if (result!=CURLE_OK) throw asiocurl::easy_error(result);
+
+	return retr;
+
+}
+
+
+SCENARIO("asiocurl::io_service::options limit the connections an asiocurl::io_service opens","[asiocurl][io_service]") {
+
+	GIVEN("Two curl easy handles which represent transfers which will not complete") {
+
+		blackhole b;
+		auto u=b.url();
+		std::vector<asiocurl::easy> easies(2);
+		for (auto && easy : easies) set(easy,CURLOPT_URL,u.c_str());
+		asiocurl::asio::io_service ios;
+
+		WHEN("They are added to an asiocurl::io_service which permits only one connection") {
+
+			asiocurl::io_service::options o;
+			o.max_total_connections=1;
+			asiocurl::io_service curl(ios,o);
+			auto g=asiocurl::make_scope_exit([&] () noexcept {	for (auto && easy : easies) curl.remove(easy);	});
+			for (auto && easy : easies) curl.add(easy);
+			ios.run_for(std::chrono::milliseconds(200));
+
+			THEN("Only the first transfer connects") {
+
+				CHECK(primary_port(easies[0])!=0);
+				CHECK(primary_port(easies[1])==0);
+
+			}
+
+		}
+
+		WHEN("They are added to an asiocurl::io_service whose limit is lifted by asiocurl::io_service::set_options") {
+
+			asiocurl::io_service::options o;
+			o.max_total_connections=1;
+			asiocurl::io_service curl(ios,o);
+			o.max_total_connections=0;
+			curl.set_options(o);
+			auto g=asiocurl::make_scope_exit([&] () noexcept {	for (auto && easy : easies) curl.remove(easy);	});
+			for (auto && easy : easies) curl.add(easy);
+			ios.run_for(std::chrono::milliseconds(200));
+
+			THEN("Both transfers connect") {
+
+				CHECK(primary_port(easies[0])!=0);
+				CHECK(primary_port(easies[1])!=0);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service objects which limit the number of transfers in flight hold the remainder in a queue","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service which permits one transfer in flight and three curl easy handles which represent transfers which will not complete") {
+
+		blackhole b;
+		auto u=b.url();
+		std::vector<asiocurl::easy> easies(3);
+		for (auto && easy : easies) set(easy,CURLOPT_URL,u.c_str());
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service::options o;
+		o.max_in_flight=1;
+		asiocurl::io_service curl(ios,o);
+		auto g=asiocurl::make_scope_exit([&] () noexcept {	for (auto && easy : easies) curl.remove(easy);	});
+
+		WHEN("They are added with the same priority") {
+
+			std::vector<asiocurl::future<CURLMsg>> fs;
+			for (auto && easy : easies) fs.push_back(curl.add(easy));
+
+			THEN("All are managed by the asiocurl::io_service but only the first is in flight") {
+
+				CHECK(curl.size()==3);
+				CHECK(curl.queued()==2);
+
+			}
+
+			AND_WHEN("A waiting transfer is removed") {
+
+				REQUIRE(curl.remove(easies[2]));
+
+				THEN("It is aborted") {
+
+					CHECK_THROWS_AS(fs[2].get(),asiocurl::aborted);
+
+				}
+
+				THEN("No other transfer is admitted") {
+
+					CHECK(curl.size()==2);
+					CHECK(curl.queued()==1);
+
+				}
+
+			}
+
+			AND_WHEN("The transfer in flight is removed") {
+
+				REQUIRE(curl.remove(easies[0]));
+
+				THEN("The next transfer is admitted") {
+
+					CHECK(curl.size()==2);
+					CHECK(curl.queued()==1);
+
+				}
+
+			}
+
+			AND_WHEN("The limit is lifted by asiocurl::io_service::set_options") {
+
+				o.max_in_flight=0;
+				curl.set_options(o);
+
+				THEN("All transfers are admitted") {
+
+					CHECK(curl.queued()==0);
+
+				}
+
+			}
+
+		}
+
+		WHEN("A normal priority transfer is in flight and a low and high priority transfer are waiting") {
+
+			curl.add(easies[0]);
+			curl.add(easies[1],asiocurl::io_service::priority::low);
+			curl.add(easies[2],asiocurl::io_service::priority::high);
+			REQUIRE(curl.queued()==2);
+
+			AND_WHEN("The transfer in flight is removed") {
+
+				REQUIRE(curl.remove(easies[0]));
+				ios.run_for(std::chrono::milliseconds(200));
+
+				THEN("The high priority transfer is admitted") {
+
+					CHECK(primary_port(easies[2])!=0);
+					CHECK(primary_port(easies[1])==0);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO_METHOD(fixture,"asiocurl::io_service does not allocate memory for asynchronous operations once a transfer reaches a steady state","[asiocurl][io_service]") {
+
+	GIVEN("A curl easy handle which represents the download of a large body") {
+
+		streamer server(64*1024*1024);
+		asiocurl::easy easy;
+		auto u=server.url();
+		set(easy,CURLOPT_URL,u.c_str());
+		allocation_counter counter(64,1024);
+		set(easy,CURLOPT_WRITEFUNCTION,&allocation_counter::write);
+		set(easy,CURLOPT_WRITEDATA,static_cast<void *>(&counter));
+
+		WHEN("It is added to an asiocurl::io_service and asiocurl::asio::io_service::run is invoked") {
+
+			auto f=curl.add(easy);
+			runner r(ios);
+
+			THEN("The transfer completes successfully") {
+
+				REQUIRE(f.get().data.result==CURLE_OK);
+				REQUIRE(counter.complete());
+
+				AND_THEN("No memory was allocated while it was streaming") {
+
+					CHECK(counter.allocations==0);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO_METHOD(fixture,"asiocurl::io_service::async_perform reports the completion of transfers through completion tokens","[asiocurl][io_service]") {
+
+	GIVEN("A curl easy handle which represents a transfer which should complete") {
+
+		streamer server(16);
+		asiocurl::easy easy;
+		auto u=server.url();
+		set(easy,CURLOPT_URL,u.c_str());
+		set(easy,CURLOPT_WRITEFUNCTION,&discard);
+
+		WHEN("It is passed to asiocurl::io_service::async_perform with a callback") {
+
+			bool invoked=false;
+			asiocurl::error_code ec;
+			CURLMsg msg{};
+			curl.async_perform(easy,[&] (auto e, auto m) {
+
+				invoked=true;
+				ec=e;
+				msg=m;
+
+			});
+
+			auto immediately=invoked;
+			while (!invoked) ios.run_one();
+
+			THEN("The callback was not invoked immediately") {
+
+				CHECK_FALSE(immediately);
+
+			}
+
+			THEN("The transfer completed successfully") {
+
+				CHECK_FALSE(ec);
+				CHECK(msg.msg==CURLMSG_DONE);
+				CHECK(msg.data.result==CURLE_OK);
+				CHECK(msg.easy_handle==easy.native_handle());
+
+			}
+
+		}
+
+		WHEN("It is passed to asiocurl::io_service::async_perform with asiocurl::asio::use_future") {
+
+			auto f=curl.async_perform(easy,asiocurl::asio::use_future);
+			runner r(ios);
+
+			THEN("The transfer completes successfully") {
+
+				auto msg=f.get();
+				CHECK(msg.data.result==CURLE_OK);
+				CHECK(msg.easy_handle==easy.native_handle());
+
+			}
+
+		}
+
+		#ifdef ASIOCURL_USE_BOOST_ASIO
+		WHEN("It is passed to asiocurl::io_service::async_perform with an asiocurl::asio::yield_context") {
+
+			bool done=false;
+			CURLcode result=CURLE_FAILED_INIT;
+			asiocurl::asio::spawn(ios,[&] (asiocurl::asio::yield_context yield) {
+
+				result=curl.async_perform(easy,yield).data.result;
+				done=true;
+
+			});
+			while (!done) ios.run_one();
+
+			THEN("The transfer completes successfully") {
+
+				CHECK(result==CURLE_OK);
+
+			}
+
+		}
+		#endif
+
+	}
+
+	GIVEN("A curl easy handle") {
+
+		asiocurl::easy easy;
+
+		WHEN("It is passed to asiocurl::io_service::async_perform twice") {
+
+			bool invoked=false;
+			asiocurl::error_code a;
+			asiocurl::error_code b;
+			curl.async_perform(easy,[&] (auto ec, auto) {
+
+				invoked=true;
+				a=ec;
+
+			});
+			curl.async_perform(easy,[&] (auto ec, auto) {
+
+				invoked=true;
+				b=ec;
+
+			});
+
+			auto immediately=invoked;
+
+			AND_WHEN("It is removed and asiocurl::asio::io_service::poll is invoked") {
+
+				REQUIRE(curl.remove(easy));
+				ios.poll();
+
+				THEN("Neither completion handler was invoked immediately") {
+
+					CHECK_FALSE(immediately);
+
+				}
+
+				THEN("The second operation fails") {
+
+					CHECK(b==asiocurl::asio::error::already_started);
+
+				}
+
+				THEN("The first operation is aborted") {
+
+					CHECK(a==asiocurl::asio::error::operation_aborted);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service only waits for the socket events libcurl is interested in","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service which has completed a transfer over a connection which remains open") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		asiocurl::easy easy;
+		lingerer server;
+		auto url=server.url();
+		set(easy,CURLOPT_URL,url.c_str());
+		set(easy,CURLOPT_WRITEFUNCTION,&discard);
+		CURLcode result=CURLE_FAILED_INIT;
+		curl.async_perform(easy,[&] (auto ec, auto msg) {
+
+			if (!ec) result=msg.data.result;
+
+		});
+		ios.run();
+		ios.restart();
+		REQUIRE(result==CURLE_OK);
+		auto before=curl.metrics();
+		REQUIRE(before.sockets==1);
+
+		WHEN("The idle connection becomes readable") {
+
+			server.release();
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			ios.run_for(std::chrono::milliseconds(50));
+			auto after=curl.metrics();
+
+			THEN("The asiocurl::io_service is not woken") {
+
+				CHECK(after.wakeups==before.wakeups);
+				CHECK(after.actions==before.actions);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service services a readable socket until it is drained","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service and a transfer of a long response which libcurl reads one small buffer at a time") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		streamer server(1024*1024);
+		asiocurl::easy easy;
+		set_url(easy,server.url());
+		set(easy,CURLOPT_BUFFERSIZE,1024L);
+
+		WHEN("The transfer is performed") {
+
+			CURLcode result=CURLE_FAILED_INIT;
+			curl.async_perform(easy,[&] (auto ec, auto msg) {
+
+				if (!ec) result=msg.data.result;
+
+			});
+			ios.run();
+			auto m=curl.metrics();
+
+			THEN("It succeeds") {
+
+				CHECK(result==CURLE_OK);
+
+			}
+
+			THEN("The socket is serviced more than once for some of the times it becomes readable") {
+
+				//	Each wait on the timer and each posted action cause
+				//	at most one action, if every wakeup were followed by
+				//	a single action the remainder could not exceed the
+				//	number of wakeups
+				REQUIRE(m.actions>=(m.timer_waits+m.timer_posts));
+				CHECK((m.actions-m.timer_waits-m.timer_posts)>m.wakeups);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service objects which batch events complete transfers","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service which batches events and several curl easy handles which represent transfers of long responses") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service::options o;
+		o.batch_events=true;
+		asiocurl::io_service curl(ios,o);
+		std::vector<std::unique_ptr<streamer>> servers;
+		std::vector<asiocurl::easy> easies(4);
+		for (auto && easy : easies) {
+
+			servers.push_back(std::make_unique<streamer>(1024*1024));
+			auto u=servers.back()->url();
+			set(easy,CURLOPT_URL,u.c_str());
+			set(easy,CURLOPT_WRITEFUNCTION,&discard);
+
+		}
+
+		WHEN("They are performed at once") {
+
+			std::size_t completed=0;
+			std::size_t succeeded=0;
+			for (auto && easy : easies) curl.async_perform(easy,[&] (auto ec, auto msg) {
+
+				++completed;
+				if (!ec && (msg.data.result==CURLE_OK)) ++succeeded;
+
+			});
+			ios.run();
+			auto m=curl.metrics();
+
+			THEN("All of them complete successfully") {
+
+				CHECK(completed==easies.size());
+				CHECK(succeeded==easies.size());
+				CHECK(curl.size()==0);
+
+			}
+
+			THEN("The events which occur during a pass of the reactor are acted upon together") {
+
+				CHECK(m.flushes>0);
+				CHECK(m.flushes<m.wakeups);
+
+			}
+
+			THEN("Transfers which finish together are collected together and never otherwise") {
+
+				CHECK(m.reaps>0);
+				CHECK(m.reaps<easies.size());
+				CHECK(m.reaps<m.flushes);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS) || defined(ASIO_HAS_LOCAL_SOCKETS)
+SCENARIO("asiocurl::io_service performs transfers over Unix domain sockets","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service and a curl easy handle which represents a transfer over a Unix domain socket") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		local_streamer server(1024);
+		asiocurl::easy easy;
+		auto u=server.url();
+		set(easy,CURLOPT_URL,u.c_str());
+		set(easy,CURLOPT_UNIX_SOCKET_PATH,server.path().c_str());
+		set(easy,CURLOPT_WRITEFUNCTION,&discard);
+
+		WHEN("It is performed") {
+
+			bool invoked=false;
+			asiocurl::error_code ec;
+			CURLMsg msg{};
+			asiocurl::transfer_stats stats;
+			curl.async_perform_with_stats(easy,[&] (auto e, auto m, auto s) {
+
+				invoked=true;
+				ec=e;
+				msg=m;
+				stats=s;
+
+			});
+			ios.run();
+
+			THEN("The transfer completes successfully") {
+
+				REQUIRE(invoked);
+				REQUIRE_FALSE(ec);
+				CHECK(msg.data.result==CURLE_OK);
+				CHECK(stats.response_code==200);
+				CHECK(stats.downloaded==1024);
+
+			}
+
+		}
+
+	}
+
+}
+#endif
+
+
+SCENARIO("asiocurl::io_service acts upon descriptors libcurl did not open","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service and the name of this host") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		//	libcurl resolves "localhost" itself, other names are
+		//	resolved by its resolver which signals through a
+		//	descriptor libcurl opens itself
+		auto name=asiocurl::asio::ip::host_name();
+		asiocurl::optional<asiocurl::asio::ip::address_v4> address;
+		asiocurl::asio::ip::tcp::resolver resolver(ios);
+		asiocurl::error_code ec;
+		auto results=resolver.resolve(name,"",ec);
+		if (!ec) for (auto && result : results) {
+
+			auto a=result.endpoint().address();
+			if (!a.is_v4()) continue;
+			address=a.to_v4();
+			break;
+
+		}
+		if (!address) {
+
+			WARN("The name of this host does not resolve to an IPv4 address");
+			return;
+
+		}
+
+		WHEN("Transfers to it are performed one after another without caching the resolved address") {
+
+			std::size_t succeeded=0;
+			for (std::size_t i=0;i<10;++i) {
+
+				streamer server(16,*address);
+				asiocurl::easy easy;
+				set_url(easy,server.url(name));
+				set(easy,CURLOPT_DNS_CACHE_TIMEOUT,0L);
+				curl.async_perform(easy,[&] (auto ec, auto msg) {
+
+					if (!ec && (msg.data.result==CURLE_OK)) ++succeeded;
+
+				});
+				ios.run();
+				ios.restart();
+
+			}
+			auto m=curl.metrics();
+
+			THEN("They succeed") {
+
+				CHECK(succeeded==10);
+
+			}
+
+			THEN("The asiocurl::io_service is woken only a few times for each") {
+
+				//	If libcurl were not told of the resolver's signal it
+				//	would only notice the resolved name when it next
+				//	polled (after up to 250ms), and until then the signal
+				//	would keep waking the asiocurl::io_service
+				CHECK(m.wakeups<=(5*10));
+				CHECK(m.actions<=(6*10));
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service coalesces the timeouts libcurl requests","[asiocurl][io_service]") {
+
+	GIVEN("An asiocurl::io_service and several transfers over the loopback interface") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		std::vector<std::unique_ptr<streamer>> servers;
+		std::vector<asiocurl::easy> easies(10);
+		for (auto && easy : easies) {
+
+			servers.push_back(std::make_unique<streamer>(16));
+			set_url(easy,servers.back()->url());
+
+		}
+		std::size_t succeeded=0;
+		auto handler=[&] (auto ec, auto msg) {
+
+			if (!ec && (msg.data.result==CURLE_OK)) ++succeeded;
+
+		};
+
+		WHEN("They are added") {
+
+			for (auto && easy : easies) curl.async_perform(easy,handler);
+			auto m=curl.metrics();
+
+			THEN("The zero timeouts libcurl requests are satisfied by one posted action rather than being acted upon immediately") {
+
+				CHECK(m.timer_updates>=easies.size());
+				CHECK(m.actions==0);
+				CHECK(m.timer_posts==1);
+
+			}
+
+			AND_WHEN("asiocurl::asio::io_service::run is invoked") {
+
+				ios.run();
+				auto m=curl.metrics();
+
+				THEN("They succeed") {
+
+					CHECK(succeeded==easies.size());
+
+				}
+
+				THEN("The timer is used far less often than libcurl updates it") {
+
+					CHECK(m.timer_posts<=2);
+					CHECK(m.timer_waits<=2);
+					CHECK((m.timer_posts+m.timer_waits)<m.timer_updates);
+
+				}
+
+			}
+
+		}
+
+		WHEN("They are performed one after another") {
+
+			for (auto && easy : easies) {
+
+				curl.async_perform(easy,handler);
+				ios.run();
+				ios.restart();
+
+			}
+			auto m=curl.metrics();
+
+			THEN("They succeed") {
+
+				CHECK(succeeded==easies.size());
+
+			}
+
+			THEN("The timer is posted to and waited upon at most once for each") {
+
+				CHECK(m.timer_posts<=easies.size());
+				CHECK(m.timer_waits<=easies.size());
+				CHECK((m.timer_posts+m.timer_waits)<m.timer_updates);
+
+			}
+
+		}
+
+	}
+
+}
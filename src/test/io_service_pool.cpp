@@ -0,0 +1,137 @@
+#include <asiocurl/io_service_pool.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/optional.hpp>
+#include <curl/curl.h>
+#include <stdexcept>
+#include <string>
+#include <catch.hpp>
+
+
+SCENARIO("asiocurl::io_service_pool objects must have at least one shard","[asiocurl][io_service_pool]") {
+
+	CHECK_THROWS_AS(asiocurl::io_service_pool(0),std::invalid_argument);
+
+}
+
+
+SCENARIO("asiocurl::io_service_pool::remove may be used to abort transfers","[asiocurl][io_service_pool]") {
+
+	GIVEN("An asiocurl::io_service_pool and a curl easy handle") {
+
+		blackhole b;
+		asiocurl::easy easy;
+		set_url(easy,b.url());
+		asiocurl::optional<asiocurl::io_service_pool> pool(asiocurl::in_place,2);
+
+		THEN("Passing it to asiocurl::io_service_pool::remove returns false") {
+
+			CHECK_FALSE(pool->remove(easy));
+
+		}
+
+		WHEN("It is added to the asiocurl::io_service_pool") {
+
+			auto f=pool->add(easy);
+
+			THEN("Passing it to asiocurl::io_service_pool::remove returns true") {
+
+				REQUIRE(pool->remove(easy));
+
+				AND_THEN("The transfer is aborted") {
+
+					CHECK_THROWS_AS(f.get(),asiocurl::aborted);
+
+				}
+
+			}
+
+			AND_WHEN("The lifetime of the asiocurl::io_service_pool ends") {
+
+				pool=asiocurl::nullopt;
+
+				THEN("The transfer is aborted") {
+
+					CHECK_THROWS_AS(f.get(),asiocurl::aborted);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service_pool distributes transfers across shards","[asiocurl][io_service_pool]") {
+
+	blackhole b;
+	asiocurl::easy a;
+	asiocurl::easy c;
+	asiocurl::easy d;
+	asiocurl::easy e;
+	for (auto easy : {a.native_handle(),c.native_handle(),d.native_handle(),e.native_handle()}) set_url(easy,b.url());
+
+	GIVEN("An asiocurl::io_service_pool using the round robin policy") {
+
+		asiocurl::io_service_pool pool(2,asiocurl::io_service_pool::policy::round_robin);
+
+		WHEN("Four transfers are added") {
+
+			pool.add(a);
+			pool.add(c);
+			pool.add(d);
+			pool.add(e);
+
+			THEN("Each shard manages two transfers") {
+
+				CHECK(pool[0].size()==2);
+				CHECK(pool[1].size()==2);
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::io_service_pool using the least in flight policy") {
+
+		asiocurl::io_service_pool pool(2,asiocurl::io_service_pool::policy::least_in_flight);
+
+		WHEN("Two transfers are added") {
+
+			pool.add(a);
+			pool.add(c);
+
+			THEN("Each shard manages one transfer") {
+
+				CHECK(pool[0].size()==1);
+				CHECK(pool[1].size()==1);
+
+			}
+
+			AND_WHEN("One is removed and another is added") {
+
+				REQUIRE(pool.remove(a));
+				pool.add(d);
+
+				THEN("The new transfer is added to the shard which was left idle") {
+
+					CHECK(pool[0].size()==1);
+					CHECK(pool[1].size()==1);
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
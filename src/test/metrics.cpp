@@ -0,0 +1,112 @@
+#include <asiocurl/metrics.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <string>
+#include <catch.hpp>
+
+
+SCENARIO("asiocurl::io_service objects maintain metrics","[asiocurl][metrics][io_service]") {
+
+	GIVEN("An instrumented asiocurl::io_service and an easy handle") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service::options o;
+		o.instrument=true;
+		asiocurl::io_service curl(ios,o);
+		asiocurl::easy easy;
+
+		THEN("Its metrics are initially zero") {
+
+			auto m=curl.metrics();
+			CHECK(m.started==0);
+			CHECK(m.completed==0);
+			CHECK(m.aborted==0);
+			CHECK(m.handles==0);
+			CHECK(m.sockets==0);
+			CHECK(m.total.count()==0);
+
+		}
+
+		WHEN("A transfer is performed") {
+
+			streamer server(16);
+			set_url(easy,server.url());
+			curl.async_perform(easy,[] (auto, auto) {	});
+			auto during=curl.metrics();
+			ios.run();
+			auto after=curl.metrics();
+
+			THEN("It is counted as in flight while it is in progress") {
+
+				CHECK(during.started==1);
+				CHECK(during.handles==1);
+				CHECK(during.in_flight==1);
+				CHECK(during.completed==0);
+
+			}
+
+			THEN("Its completion, size, and latency are recorded") {
+
+				CHECK(after.started==1);
+				CHECK(after.completed==1);
+				CHECK(after.aborted==0);
+				CHECK(after.handles==0);
+				CHECK(after.in_flight==0);
+				CHECK(after.bytes_in==16);
+				CHECK(after.total.count()==1);
+				CHECK(after.total.max().count()>0);
+				CHECK(after.start_transfer.count()==1);
+				CHECK(after.wakeups>0);
+				CHECK(after.actions>=after.wakeups);
+				//	Only the action after which the transfer was no
+				//	longer running collected it
+				CHECK(after.reaps==1);
+				CHECK(after.flushes==0);
+
+			}
+
+			AND_WHEN("The metrics are merged with themselves") {
+
+				after.merge(after);
+
+				THEN("Counters are summed") {
+
+					CHECK(after.completed==2);
+					CHECK(after.bytes_in==32);
+					CHECK(after.total.count()==2);
+
+				}
+
+			}
+
+		}
+
+		WHEN("A transfer is removed") {
+
+			blackhole server;
+			set_url(easy,server.url());
+			curl.async_perform(easy,[] (auto, auto) {	});
+			curl.remove(easy);
+			ios.run();
+			auto m=curl.metrics();
+
+			THEN("It is counted as aborted and no latency is recorded") {
+
+				CHECK(m.started==1);
+				CHECK(m.completed==0);
+				CHECK(m.aborted==1);
+				CHECK(m.total.count()==0);
+
+			}
+
+		}
+
+	}
+
+}
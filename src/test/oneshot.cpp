@@ -0,0 +1,244 @@
+#include <asiocurl/oneshot.hpp>
+
+
+#include "allocations.hpp"
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <catch.hpp>
+
+
+SCENARIO("asiocurl::oneshot_future objects become ready when their asiocurl::oneshot_promise provides a value","[asiocurl][oneshot]") {
+
+	GIVEN("An asiocurl::oneshot_promise and its asiocurl::oneshot_future") {
+
+		asiocurl::oneshot_promise<int> p;
+		auto f=p.get_future();
+
+		THEN("The asiocurl::oneshot_future is not ready") {
+
+			CHECK(f.valid());
+			CHECK_FALSE(f.is_ready());
+
+		}
+
+		THEN("The asiocurl::oneshot_future may not be retrieved again") {
+
+			CHECK_THROWS_AS(p.get_future(),std::future_error);
+
+		}
+
+		WHEN("A value is provided") {
+
+			p.set_value(5);
+
+			THEN("The asiocurl::oneshot_future is ready and yields that value") {
+
+				REQUIRE(f.is_ready());
+				CHECK(f.get()==5);
+				CHECK_FALSE(f.valid());
+
+			}
+
+			THEN("Another value may not be provided") {
+
+				CHECK_THROWS_AS(p.set_value(6),std::future_error);
+
+			}
+
+		}
+
+		WHEN("An exception is provided") {
+
+			p.set_exception(std::make_exception_ptr(std::runtime_error("Failed")));
+
+			THEN("Retrieving the value throws that exception") {
+
+				CHECK_THROWS_AS(f.get(),std::runtime_error);
+
+			}
+
+		}
+
+		WHEN("The lifetime of the asiocurl::oneshot_promise ends") {
+
+			{	auto moved=std::move(p);	}
+
+			THEN("Retrieving the value throws an exception") {
+
+				CHECK_THROWS_AS(f.get(),std::future_error);
+
+			}
+
+		}
+
+		WHEN("A value is provided from another thread") {
+
+			std::thread t([&] () {	p.set_value(7);	});
+			auto v=f.get();
+			t.join();
+
+			THEN("A thread blocked waiting for the value receives it") {
+
+				CHECK(v==7);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::oneshot_future::then invokes a continuation once the value is provided","[asiocurl][oneshot]") {
+
+	GIVEN("An asiocurl::oneshot_promise and its asiocurl::oneshot_future") {
+
+		//	If the value is not provided the continuation is invoked
+		//	when the asiocurl::oneshot_promise is destroyed
+		int value=0;
+		bool invoked=false;
+		auto continuation=[&] (asiocurl::oneshot_future<int> f) noexcept {
+
+			invoked=true;
+			try {
+
+				value=f.get();
+
+			} catch (...) {	}
+
+		};
+		asiocurl::oneshot_promise<int> p;
+		auto f=p.get_future();
+
+		WHEN("A continuation is attached before the value is provided") {
+
+			start_counting_allocations();
+			f.then(continuation);
+			auto allocations=stop_counting_allocations();
+
+			THEN("Attaching the continuation did not allocate memory") {
+
+				CHECK(allocations==0);
+
+			}
+
+			THEN("The asiocurl::oneshot_future no longer refers to a shared state") {
+
+				CHECK_FALSE(f.valid());
+
+			}
+
+			THEN("The continuation is not invoked") {
+
+				CHECK_FALSE(invoked);
+
+			}
+
+			AND_WHEN("The value is provided") {
+
+				p.set_value(3);
+
+				THEN("The continuation is invoked with the value") {
+
+					CHECK(invoked);
+					CHECK(value==3);
+
+				}
+
+			}
+
+		}
+
+		WHEN("A continuation is attached after the value is provided") {
+
+			p.set_value(4);
+			f.then(continuation);
+
+			THEN("The continuation is invoked immediately with the value") {
+
+				CHECK(invoked);
+				CHECK(value==4);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::make_ready_oneshot_future creates asiocurl::oneshot_future objects which are ready without a shared state","[asiocurl][oneshot]") {
+
+	GIVEN("An asiocurl::oneshot_future created by asiocurl::make_ready_oneshot_future") {
+
+		start_counting_allocations();
+		auto f=asiocurl::make_ready_oneshot_future(5);
+		auto allocations=stop_counting_allocations();
+
+		THEN("Creating it did not allocate memory") {
+
+			CHECK(allocations==0);
+
+		}
+
+		THEN("It is ready and yields its value") {
+
+			REQUIRE(f.valid());
+			REQUIRE(f.is_ready());
+			CHECK(f.get()==5);
+			CHECK_FALSE(f.valid());
+
+		}
+
+		THEN("Moving it moves its value") {
+
+			auto moved=std::move(f);
+			CHECK_FALSE(f.valid());
+			REQUIRE(moved.valid());
+			CHECK(moved.get()==5);
+
+		}
+
+		WHEN("A continuation is attached") {
+
+			int value=0;
+			f.then([&] (asiocurl::oneshot_future<int> f) noexcept {
+
+				try {
+
+					value=f.get();
+
+				} catch (...) {	}
+
+			});
+
+			THEN("The continuation is invoked immediately with the value") {
+
+				CHECK(value==5);
+				CHECK_FALSE(f.valid());
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::oneshot_future created by asiocurl::make_exceptional_oneshot_future") {
+
+		auto f=asiocurl::make_exceptional_oneshot_future<int>(std::make_exception_ptr(std::runtime_error("Failed")));
+
+		THEN("It is ready and retrieving the value throws that exception") {
+
+			REQUIRE(f.is_ready());
+			CHECK_THROWS_AS(f.get(),std::runtime_error);
+			CHECK_FALSE(f.valid());
+
+		}
+
+	}
+
+}
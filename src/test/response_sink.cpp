@@ -0,0 +1,116 @@
+#include <asiocurl/response_sink.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/slab_pool.hpp>
+#include <curl/curl.h>
+#include <cstddef>
+#include <string>
+#include <catch.hpp>
+
+
+namespace {
+
+
+	CURLcode perform (asiocurl::asio::io_service & ios, asiocurl::io_service & curl, CURL * easy) {
+
+		CURLcode result=CURLE_OK;
+		curl.async_perform(easy,[&] (auto ec, auto msg) {
+
+			if (ec) throw asiocurl::system_error(ec);
+			result=msg.data.result;
+
+		});
+		ios.run();
+		ios.restart();
+
+		return result;
+
+	}
+
+
+}
+
+
+SCENARIO("asiocurl::response_sink objects collect response bodies into slabs","[asiocurl][response_sink][slab_pool]") {
+
+	GIVEN("An asiocurl::io_service, an asiocurl::slab_pool, and an easy handle which will receive a body spanning several slabs") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		asiocurl::slab_pool pool(4096);
+		std::size_t size=10000;
+		streamer server(size);
+		asiocurl::easy easy;
+		set_url(easy,server.url());
+
+		WHEN("The body is collected by an asiocurl::response_sink") {
+
+			asiocurl::optional<asiocurl::response_sink> sink(asiocurl::in_place,pool,easy);
+			REQUIRE(perform(ios,curl,easy)==CURLE_OK);
+
+			THEN("The entire body is collected") {
+
+				CHECK(sink->size()==size);
+				CHECK(sink->str()==std::string(size,'x'));
+				CHECK(asiocurl::asio::buffer_size(sink->data())==size);
+
+			}
+
+			THEN("It is stored in the minimum number of slabs") {
+
+				CHECK(sink->data().size()==3);
+
+			}
+
+			AND_WHEN("The asiocurl::response_sink is destroyed") {
+
+				sink=asiocurl::nullopt;
+
+				THEN("The slabs are returned to the asiocurl::slab_pool") {
+
+					CHECK(pool.idle()==3);
+
+				}
+
+			}
+
+		}
+
+	}
+
+	GIVEN("An asiocurl::io_service and an easy handle which will receive a small body") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		streamer server(16);
+		asiocurl::easy easy;
+		set_url(easy,server.url());
+
+		WHEN("The body is collected by an asiocurl::response_sink using the asiocurl::io_service's asiocurl::slab_pool") {
+
+			{
+
+				asiocurl::response_sink sink(curl,easy);
+				REQUIRE(perform(ios,curl,easy)==CURLE_OK);
+				CHECK(sink.str()==std::string(16,'x'));
+				CHECK(sink.data().size()==1);
+
+			}
+
+			THEN("The slab is returned to the asiocurl::io_service's asiocurl::slab_pool") {
+
+				CHECK(curl.slabs().idle()==1);
+
+			}
+
+		}
+
+	}
+
+}
@@ -0,0 +1,533 @@
+#pragma once
+
+
+#include <asiocurl/asio.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/exception.hpp>
+#include <curl/curl.h>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+#include <future>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+
+namespace {
+
+
+	inline std::size_t discard_body (char *, std::size_t size, std::size_t nmemb, void *) noexcept {
+
+		return size*nmemb;
+
+	}
+
+
+	//	Directs an easy handle at a URL and discards the body of
+	//	the response (rather than libcurl writing it to stdout)
+	//	unless a write callback is installed afterwards
+	inline void set_url (CURL * easy, const std::string & url) {
+
+		auto result=curl_easy_setopt(easy,CURLOPT_URL,url.c_str());
+		if (result==CURLE_OK) result=curl_easy_setopt(easy,CURLOPT_WRITEFUNCTION,&discard_body);
+		if (result!=CURLE_OK) throw asiocurl::easy_error(result);
+
+	}
+
+
+	//	Listens on the loopback interface but never accepts
+	//	so that transfers directed at it remain in flight until
+	//	they are removed
+	class blackhole {
+
+
+		private:
+
+
+			asiocurl::asio::io_service ios_;
+			asiocurl::asio::ip::tcp::acceptor acceptor_;
+
+
+		public:
+
+
+			blackhole () : acceptor_(ios_,asiocurl::asio::ip::tcp::endpoint(asiocurl::asio::ip::address_v4::loopback(),0)) {	}
+
+
+			std::string url () const {
+
+				std::ostringstream ss;
+				ss << "http://127.0.0.1:" << acceptor_.local_endpoint().port() << "/";
+
+				return ss.str();
+
+			}
+
+
+	};
+
+
+	//	Answers a single request on the loopback interface (or
+	//	some other IPv4 address) with a body of the requested size
+	class streamer {
+
+
+		private:
+
+
+			asiocurl::asio::io_service ios_;
+			asiocurl::asio::ip::tcp::acceptor acceptor_;
+			asiocurl::asio::ip::tcp::socket socket_;
+			asiocurl::asio::streambuf request_;
+			std::string header_;
+			std::string chunk_;
+			std::size_t remaining_;
+			std::thread t_;
+
+
+			void body () {
+
+				if (remaining_==0) {
+
+					asiocurl::error_code ec;
+					socket_.shutdown(asiocurl::asio::ip::tcp::socket::shutdown_both,ec);
+					return;
+
+				}
+				auto n=(remaining_<chunk_.size()) ? remaining_ : chunk_.size();
+				remaining_-=n;
+				asiocurl::asio::async_write(socket_,asiocurl::asio::buffer(chunk_.data(),n),[this] (const auto & ec, auto) {
+
+					if (!ec) body();
+
+				});
+
+			}
+
+
+		public:
+
+
+			streamer () = delete;
+			streamer (const streamer &) = delete;
+			streamer (streamer &&) = delete;
+			streamer & operator = (const streamer &) = delete;
+			streamer & operator = (streamer &&) = delete;
+
+
+			explicit streamer (std::size_t size) : streamer(size,asiocurl::asio::ip::address_v4::loopback()) {	}
+
+
+			streamer (std::size_t size, const asiocurl::asio::ip::address_v4 & address)
+				:	acceptor_(ios_,asiocurl::asio::ip::tcp::endpoint(address,0)),
+					socket_(ios_),
+					chunk_(64*1024,'x'),
+					remaining_(size)
+			{
+
+				std::ostringstream ss;
+				ss << "HTTP/1.1 200 OK\r\nContent-Length: " << size << "\r\n\r\n";
+				header_=ss.str();
+
+				acceptor_.async_accept(socket_,[this] (const auto & ec) {
+
+					if (ec) return;
+					asiocurl::asio::async_read_until(socket_,request_,"\r\n\r\n",[this] (const auto & ec, auto) {
+
+						if (ec) return;
+						asiocurl::asio::async_write(socket_,asiocurl::asio::buffer(header_),[this] (const auto & ec, auto) {
+
+							if (!ec) body();
+
+						});
+
+					});
+
+				});
+				t_=std::thread([this] () noexcept {
+
+					try {
+
+						ios_.run();
+
+					} catch (...) {	}
+
+				});
+
+			}
+
+
+			~streamer () noexcept {
+
+				ios_.stop();
+				t_.join();
+
+			}
+
+
+			std::string url () const {
+
+				return url(acceptor_.local_endpoint().address().to_string());
+
+			}
+
+
+			//	The URL by which the server is reached through a
+			//	host name
+			std::string url (const std::string & host) const {
+
+				std::ostringstream ss;
+				ss << "http://" << host << ":" << acceptor_.local_endpoint().port() << "/";
+
+				return ss.str();
+
+			}
+
+
+	};
+
+
+	//	Accepts a single request on the loopback interface and
+	//	records its body, which may use either a Content-Length
+	//	or chunked transfer encoding
+	class collector {
+
+
+		private:
+
+
+			asiocurl::asio::io_service ios_;
+			asiocurl::asio::ip::tcp::acceptor acceptor_;
+			std::promise<std::string> promise_;
+			std::thread t_;
+
+
+			static std::string line (asiocurl::asio::ip::tcp::socket & socket, asiocurl::asio::streambuf & buffer) {
+
+				auto n=asiocurl::asio::read_until(socket,buffer,"\r\n");
+				std::string retr(asiocurl::asio::buffers_begin(buffer.data()),asiocurl::asio::buffers_begin(buffer.data())+n-2);
+				buffer.consume(n);
+
+				return retr;
+
+			}
+
+
+			static void append (asiocurl::asio::ip::tcp::socket & socket, asiocurl::asio::streambuf & buffer, std::size_t n, std::string & body) {
+
+				if (buffer.size()<n) asiocurl::asio::read(socket,buffer,asiocurl::asio::transfer_exactly(n-buffer.size()));
+				body.append(asiocurl::asio::buffers_begin(buffer.data()),asiocurl::asio::buffers_begin(buffer.data())+n);
+				buffer.consume(n);
+
+			}
+
+
+			void serve () {
+
+				asiocurl::asio::ip::tcp::socket socket(ios_);
+				acceptor_.accept(socket);
+				asiocurl::asio::streambuf buffer;
+
+				line(socket,buffer);
+				std::size_t length=0;
+				bool chunked=false;
+				for (auto header=line(socket,buffer);!header.empty();header=line(socket,buffer)) {
+
+					for (auto && c : header) c=static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+					if (header.compare(0,15,"content-length:")==0) length=std::strtoull(header.c_str()+15,nullptr,10);
+					else if (header.find("transfer-encoding: chunked")==0) chunked=true;
+					else if (header.find("expect: 100-continue")==0) asiocurl::asio::write(socket,asiocurl::asio::buffer(std::string("HTTP/1.1 100 Continue\r\n\r\n")));
+
+				}
+
+				std::string body;
+				if (chunked) for (;;) {
+
+					auto size=std::strtoull(line(socket,buffer).c_str(),nullptr,16);
+					append(socket,buffer,size,body);
+					line(socket,buffer);
+					if (size==0) break;
+
+				} else {
+
+					append(socket,buffer,length,body);
+
+				}
+
+				asiocurl::asio::write(socket,asiocurl::asio::buffer(std::string("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n")));
+				promise_.set_value(std::move(body));
+
+			}
+
+
+		public:
+
+
+			collector (const collector &) = delete;
+			collector (collector &&) = delete;
+			collector & operator = (const collector &) = delete;
+			collector & operator = (collector &&) = delete;
+
+
+			collector () : acceptor_(ios_,asiocurl::asio::ip::tcp::endpoint(asiocurl::asio::ip::address_v4::loopback(),0)) {
+
+				t_=std::thread([this] () noexcept {
+
+					try {
+
+						serve();
+
+					} catch (...) {
+
+						try {
+
+							promise_.set_exception(std::current_exception());
+
+						} catch (...) {	}
+
+					}
+
+				});
+
+			}
+
+
+			~collector () noexcept {
+
+				//	Unblocks the thread should no request have been made
+				try {
+
+					asiocurl::asio::ip::tcp::socket socket(ios_);
+					socket.connect(acceptor_.local_endpoint());
+
+				} catch (...) {	}
+				t_.join();
+
+			}
+
+
+			std::string url () const {
+
+				std::ostringstream ss;
+				ss << "http://127.0.0.1:" << acceptor_.local_endpoint().port() << "/";
+
+				return ss.str();
+
+			}
+
+
+			//	Blocks until the request has been received
+			std::string body () {
+
+				return promise_.get_future().get();
+
+			}
+
+
+	};
+
+
+	//	Answers a single request on the loopback interface with
+	//	a two byte body and keeps the connection open (and idle)
+	//	until it is released, at which point it closes it
+	class lingerer {
+
+
+		private:
+
+
+			asiocurl::asio::io_service ios_;
+			asiocurl::asio::ip::tcp::acceptor acceptor_;
+			std::promise<void> release_;
+			std::thread t_;
+
+
+			void serve () {
+
+				asiocurl::asio::ip::tcp::socket socket(ios_);
+				acceptor_.accept(socket);
+				asiocurl::asio::streambuf buffer;
+				asiocurl::asio::read_until(socket,buffer,"\r\n\r\n");
+				asiocurl::asio::write(socket,asiocurl::asio::buffer(std::string("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK")));
+				release_.get_future().wait();
+				asiocurl::error_code ec;
+				socket.shutdown(asiocurl::asio::ip::tcp::socket::shutdown_both,ec);
+
+			}
+
+
+		public:
+
+
+			lingerer (const lingerer &) = delete;
+			lingerer (lingerer &&) = delete;
+			lingerer & operator = (const lingerer &) = delete;
+			lingerer & operator = (lingerer &&) = delete;
+
+
+			lingerer () : acceptor_(ios_,asiocurl::asio::ip::tcp::endpoint(asiocurl::asio::ip::address_v4::loopback(),0)) {
+
+				t_=std::thread([this] () noexcept {
+
+					try {
+
+						serve();
+
+					} catch (...) {	}
+
+				});
+
+			}
+
+
+			~lingerer () noexcept {
+
+				release();
+				//	Unblocks the thread should no request have been made
+				try {
+
+					asiocurl::asio::ip::tcp::socket socket(ios_);
+					socket.connect(acceptor_.local_endpoint());
+
+				} catch (...) {	}
+				t_.join();
+
+			}
+
+
+			std::string url () const {
+
+				std::ostringstream ss;
+				ss << "http://127.0.0.1:" << acceptor_.local_endpoint().port() << "/";
+
+				return ss.str();
+
+			}
+
+
+			//	Closes the connection
+			void release () noexcept {
+
+				try {
+
+					release_.set_value();
+
+				} catch (...) {	}
+
+			}
+
+
+	};
+
+
+	#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS) || defined(ASIO_HAS_LOCAL_SOCKETS)
+	//	Answers a single request on a Unix domain socket with a
+	//	body of the requested size
+	class local_streamer {
+
+
+		private:
+
+
+			asiocurl::asio::io_service ios_;
+			std::string path_;
+			asiocurl::asio::local::stream_protocol::acceptor acceptor_;
+			std::size_t size_;
+			std::thread t_;
+
+
+			static std::string make_path (const void * self) {
+
+				std::ostringstream ss;
+				ss << "/tmp/asiocurl-" << ::getpid() << "-" << self << ".sock";
+
+				return ss.str();
+
+			}
+
+
+			void serve () {
+
+				asiocurl::asio::local::stream_protocol::socket socket(ios_);
+				acceptor_.accept(socket);
+				asiocurl::asio::streambuf buffer;
+				asiocurl::asio::read_until(socket,buffer,"\r\n\r\n");
+				std::ostringstream ss;
+				ss << "HTTP/1.1 200 OK\r\nContent-Length: " << size_ << "\r\n\r\n" << std::string(size_,'x');
+				asiocurl::asio::write(socket,asiocurl::asio::buffer(ss.str()));
+				asiocurl::error_code ec;
+				socket.shutdown(asiocurl::asio::local::stream_protocol::socket::shutdown_both,ec);
+
+			}
+
+
+		public:
+
+
+			local_streamer (const local_streamer &) = delete;
+			local_streamer (local_streamer &&) = delete;
+			local_streamer & operator = (const local_streamer &) = delete;
+			local_streamer & operator = (local_streamer &&) = delete;
+
+
+			explicit local_streamer (std::size_t size)
+				:	path_(make_path(this)),
+					acceptor_(ios_),
+					size_(size)
+			{
+
+				std::remove(path_.c_str());
+				acceptor_.open();
+				acceptor_.bind(asiocurl::asio::local::stream_protocol::endpoint(path_));
+				acceptor_.listen();
+				t_=std::thread([this] () noexcept {
+
+					try {
+
+						serve();
+
+					} catch (...) {	}
+
+				});
+
+			}
+
+
+			~local_streamer () noexcept {
+
+				//	Unblocks the thread should no request have been made
+				try {
+
+					asiocurl::asio::local::stream_protocol::socket socket(ios_);
+					socket.connect(acceptor_.local_endpoint());
+
+				} catch (...) {	}
+				t_.join();
+				std::remove(path_.c_str());
+
+			}
+
+
+			//	The path to be passed as CURLOPT_UNIX_SOCKET_PATH
+			const std::string & path () const noexcept {
+
+				return path_;
+
+			}
+
+
+			std::string url () const {
+
+				return "http://localhost/";
+
+			}
+
+
+	};
+	#endif
+
+
+}
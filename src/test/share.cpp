@@ -0,0 +1,111 @@
+#include <asiocurl/share.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/scope.hpp>
+#include <curl/curl.h>
+#include <string>
+#include <catch.hpp>
+
+
+namespace {
+
+
+	//	libcurl refuses to change what a share handle shares
+	//	while any easy handle uses it
+	bool in_use (asiocurl::share & sh) {
+
+		auto result=curl_share_setopt(sh,CURLSHOPT_SHARE,CURL_LOCK_DATA_COOKIE);
+		if (result==CURLSHE_IN_USE) return true;
+		if (result!=CURLSHE_OK) throw asiocurl::share_error(result);
+
+		return false;
+
+	}
+
+
+}
+
+
+SCENARIO("asiocurl::share objects manage curl share handles","[asiocurl][share]") {
+
+	GIVEN("An asiocurl::share") {
+
+		asiocurl::share sh;
+
+		THEN("It manages a curl share handle") {
+
+			CHECK(sh.native_handle()!=nullptr);
+			CHECK(static_cast<CURLSH *>(sh)==sh.native_handle());
+
+		}
+
+		THEN("It is not in use") {
+
+			CHECK_FALSE(in_use(sh));
+
+		}
+
+	}
+
+	GIVEN("A type of data which cannot be shared") {
+
+		WHEN("An asiocurl::share is created which shares it") {
+
+			THEN("An exception is thrown") {
+
+				CHECK_THROWS_AS(asiocurl::share({CURL_LOCK_DATA_NONE}),asiocurl::share_error);
+
+			}
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service objects attach an asiocurl::share to the easy handles they manage","[asiocurl][share][io_service]") {
+
+	GIVEN("An asiocurl::io_service with an asiocurl::share and an easy handle") {
+
+		asiocurl::share sh;
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios,sh);
+		blackhole b;
+		auto u=b.url();
+		asiocurl::easy easy;
+		REQUIRE(curl_easy_setopt(easy,CURLOPT_URL,u.c_str())==CURLE_OK);
+
+		WHEN("The easy handle is added to the asiocurl::io_service") {
+
+			auto f=curl.add(easy);
+			auto g=asiocurl::make_scope_exit([&] () noexcept {	curl.remove(easy);	});
+
+			THEN("The asiocurl::share is in use") {
+
+				CHECK(in_use(sh));
+
+			}
+
+			AND_WHEN("The easy handle is removed") {
+
+				REQUIRE(curl.remove(easy));
+
+				THEN("The asiocurl::share is no longer in use") {
+
+					CHECK_FALSE(in_use(sh));
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
@@ -0,0 +1,106 @@
+#include <asiocurl/transfer_stats.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <chrono>
+#include <string>
+#include <catch.hpp>
+
+
+SCENARIO("asiocurl::transfer_stats objects are initially zero","[asiocurl][transfer_stats]") {
+
+	GIVEN("A default constructed asiocurl::transfer_stats object") {
+
+		asiocurl::transfer_stats stats;
+
+		THEN("All its members are zero") {
+
+			CHECK(stats.name_lookup.count()==0);
+			CHECK(stats.connect.count()==0);
+			CHECK(stats.app_connect.count()==0);
+			CHECK(stats.start_transfer.count()==0);
+			CHECK(stats.total.count()==0);
+			CHECK(stats.downloaded==0);
+			CHECK(stats.uploaded==0);
+			CHECK(stats.response_code==0);
+			CHECK_FALSE(stats.reused);
+
+		}
+
+	}
+
+}
+
+
+SCENARIO("asiocurl::io_service::async_perform_with_stats delivers the statistics of a transfer with its completion","[asiocurl][transfer_stats][io_service]") {
+
+	GIVEN("An asiocurl::io_service and an easy handle") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		asiocurl::easy easy;
+		bool invoked=false;
+		asiocurl::error_code ec;
+		CURLMsg msg{};
+		asiocurl::transfer_stats stats;
+		auto handler=[&] (auto e, auto m, auto s) {
+
+			invoked=true;
+			ec=e;
+			msg=m;
+			stats=s;
+
+		};
+
+		WHEN("The easy handle performs a successful transfer") {
+
+			streamer server(16);
+			set_url(easy,server.url());
+			curl.async_perform_with_stats(easy,handler);
+			ios.run();
+
+			THEN("The completion handler is invoked with statistics describing the transfer") {
+
+				REQUIRE(invoked);
+				REQUIRE_FALSE(ec);
+				REQUIRE(msg.data.result==CURLE_OK);
+				CHECK(stats.downloaded==16);
+				CHECK(stats.uploaded==0);
+				CHECK(stats.response_code==200);
+				CHECK_FALSE(stats.reused);
+				CHECK(stats.total.count()>0);
+				CHECK(stats.start_transfer<=stats.total);
+				CHECK(stats.connect<=stats.start_transfer);
+
+			}
+
+		}
+
+		WHEN("The transfer is removed before it completes") {
+
+			blackhole server;
+			set_url(easy,server.url());
+			curl.async_perform_with_stats(easy,handler);
+			REQUIRE(curl.remove(easy));
+			ios.run();
+
+			THEN("The completion handler is invoked with an error and zero statistics") {
+
+				REQUIRE(invoked);
+				CHECK(ec);
+				CHECK(stats.total.count()==0);
+				CHECK(stats.response_code==0);
+
+			}
+
+		}
+
+	}
+
+}
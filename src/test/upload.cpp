@@ -0,0 +1,132 @@
+#include <asiocurl/upload.hpp>
+
+
+#include "servers.hpp"
+#include <asiocurl/asio.hpp>
+#include <asiocurl/easy.hpp>
+#include <asiocurl/error.hpp>
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <curl/curl.h>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+
+
+namespace {
+
+
+	template <typename T>
+	void set (CURL * easy, CURLoption option, T param) {
+
+		auto result=curl_easy_setopt(easy,option,param);
+		if (result!=CURLE_OK) throw asiocurl::easy_error(result);
+
+	}
+
+
+}
+
+
+SCENARIO("asiocurl::upload objects supply request bodies from const buffer sequences","[asiocurl][upload]") {
+
+	GIVEN("An asiocurl::io_service, a server, and an easy handle which will POST to it") {
+
+		asiocurl::asio::io_service ios;
+		asiocurl::io_service curl(ios);
+		collector server;
+		auto u=server.url();
+		asiocurl::easy easy;
+		set(easy,CURLOPT_URL,u.c_str());
+		set(easy,CURLOPT_POST,1L);
+		CURLcode result=CURLE_OK;
+		asiocurl::error_code ec;
+		auto handler=[&] (auto e, auto msg) {
+
+			ec=e;
+			result=msg.data.result;
+
+		};
+
+		WHEN("The request body is a const buffer sequence") {
+
+			std::string a(512*1024,'a');
+			std::string b(3,'b');
+			std::string c(512*1024,'c');
+			std::vector<asiocurl::asio::const_buffer> buffers{asiocurl::asio::buffer(a),asiocurl::asio::buffer(b),asiocurl::asio::buffer(c)};
+			asiocurl::upload up(curl,easy,buffers);
+			CHECK(up.pending()==(a.size()+b.size()+c.size()));
+			curl.async_perform(easy,handler);
+			ios.run();
+
+			THEN("The transfer succeeds") {
+
+				CHECK_FALSE(ec);
+				CHECK(result==CURLE_OK);
+
+			}
+
+			THEN("The server receives the buffers in order") {
+
+				CHECK(server.body()==(a+b+c));
+
+			}
+
+			THEN("All buffers were consumed") {
+
+				CHECK(up.pending()==0);
+
+			}
+
+			THEN("Further buffers may not be written") {
+
+				CHECK_THROWS_AS(up.write(asiocurl::asio::buffer(a)),std::logic_error);
+
+			}
+
+		}
+
+		WHEN("The request body is produced while the transfer is in progress") {
+
+			asiocurl::upload up(curl,easy);
+			auto first=std::make_shared<std::string>("Hello ");
+			std::weak_ptr<std::string> weak(first);
+			up.write(std::move(first));
+			asiocurl::asio::steady_timer timer(ios);
+			timer.expires_after(std::chrono::milliseconds(50));
+			timer.async_wait([&] (auto) {
+
+				up.write(std::make_shared<std::string>("world"));
+				up.close();
+
+			});
+			curl.async_perform(easy,handler);
+			ios.run();
+
+			THEN("The transfer succeeds") {
+
+				CHECK_FALSE(ec);
+				CHECK(result==CURLE_OK);
+
+			}
+
+			THEN("The server receives all the data") {
+
+				CHECK(server.body()=="Hello world");
+
+			}
+
+			THEN("Buffers are released once they are consumed") {
+
+				CHECK(weak.expired());
+
+			}
+
+		}
+
+	}
+
+}
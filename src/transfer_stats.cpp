@@ -0,0 +1,51 @@
+#include <asiocurl/transfer_stats.hpp>
+#include <curl/curl.h>
+#include <chrono>
+
+
+namespace asiocurl {
+
+
+	static std::chrono::microseconds duration (CURL * easy, CURLINFO info) noexcept {
+
+		curl_off_t us=0;
+		if (curl_easy_getinfo(easy,info,&us)!=CURLE_OK) us=0;
+
+		return std::chrono::microseconds(us);
+
+	}
+
+
+	transfer_stats::transfer_stats () noexcept
+		:	name_lookup(0),
+			connect(0),
+			app_connect(0),
+			start_transfer(0),
+			total(0),
+			downloaded(0),
+			uploaded(0),
+			response_code(0),
+			reused(false)
+	{	}
+
+
+	transfer_stats transfer_stats::capture (CURL * easy) noexcept {
+
+		transfer_stats retr;
+		retr.name_lookup=duration(easy,CURLINFO_NAMELOOKUP_TIME_T);
+		retr.connect=duration(easy,CURLINFO_CONNECT_TIME_T);
+		retr.app_connect=duration(easy,CURLINFO_APPCONNECT_TIME_T);
+		retr.start_transfer=duration(easy,CURLINFO_STARTTRANSFER_TIME_T);
+		retr.total=duration(easy,CURLINFO_TOTAL_TIME_T);
+		if (curl_easy_getinfo(easy,CURLINFO_SIZE_DOWNLOAD_T,&retr.downloaded)!=CURLE_OK) retr.downloaded=0;
+		if (curl_easy_getinfo(easy,CURLINFO_SIZE_UPLOAD_T,&retr.uploaded)!=CURLE_OK) retr.uploaded=0;
+		if (curl_easy_getinfo(easy,CURLINFO_RESPONSE_CODE,&retr.response_code)!=CURLE_OK) retr.response_code=0;
+		long connects=0;
+		if (curl_easy_getinfo(easy,CURLINFO_NUM_CONNECTS,&connects)==CURLE_OK) retr.reused=connects==0;
+
+		return retr;
+
+	}
+
+
+}
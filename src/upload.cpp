@@ -0,0 +1,120 @@
+#include <asiocurl/exception.hpp>
+#include <asiocurl/io_service.hpp>
+#include <asiocurl/upload.hpp>
+#include <curl/curl.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+
+namespace asiocurl {
+
+
+	template <typename T>
+	static void setopt (CURL * easy, CURLoption option, T param) {
+
+		auto result=curl_easy_setopt(easy,option,param);
+		if (result!=CURLE_OK) throw easy_error(result);
+
+	}
+
+
+	std::size_t upload::read (char * ptr, std::size_t size, std::size_t nitems, void * userdata) noexcept {
+
+		auto & self=*static_cast<upload *>(userdata);
+		auto n=size*nitems;
+
+		std::lock_guard<std::mutex> l(self.m_);
+		std::size_t copied=0;
+		while ((copied!=n) && !self.chunks_.empty()) {
+
+			auto & c=self.chunks_.front();
+			auto k=std::min(c.buffer.size()-self.offset_,n-copied);
+			std::memcpy(ptr+copied,static_cast<const char *>(c.buffer.data())+self.offset_,k);
+			copied+=k;
+			self.offset_+=k;
+			if (self.offset_==c.buffer.size()) {
+
+				self.chunks_.pop_front();
+				self.offset_=0;
+
+			}
+
+		}
+		self.size_-=copied;
+
+		if (copied!=0) return copied;
+		//	Returning zero ends the request body
+		if (self.closed_) return 0;
+
+		self.paused_=true;
+		return CURL_READFUNC_PAUSE;
+
+	}
+
+
+	void upload::check () const {
+
+		if (closed_) throw std::logic_error("Attempt to write to closed upload");
+
+	}
+
+
+	void upload::resume (std::unique_lock<std::mutex> & l) noexcept {
+
+		if (!paused_) return;
+		paused_=false;
+		//	libcurl invokes the read callback from within
+		//	curl_easy_pause, which acquires the lock
+		l.unlock();
+		curl_.unpause(easy_);
+
+	}
+
+
+	void upload::set_size () {
+
+		auto size=static_cast<curl_off_t>(size_);
+		setopt(easy_,CURLOPT_INFILESIZE_LARGE,size);
+		setopt(easy_,CURLOPT_POSTFIELDSIZE_LARGE,size);
+
+	}
+
+
+	upload::upload (io_service & curl, CURL * easy)
+		:	curl_(curl),
+			easy_(easy),
+			offset_(0),
+			size_(0),
+			closed_(false),
+			paused_(false)
+	{
+
+		setopt(easy_,CURLOPT_READFUNCTION,&read);
+		setopt(easy_,CURLOPT_READDATA,static_cast<void *>(this));
+
+	}
+
+
+	void upload::close () {
+
+		std::unique_lock<std::mutex> l(m_);
+		check();
+		closed_=true;
+		resume(l);
+
+	}
+
+
+	std::size_t upload::pending () const noexcept {
+
+		std::lock_guard<std::mutex> l(m_);
+
+		return size_;
+
+	}
+
+
+}